@@ -32,9 +32,14 @@ target_link_options(default_sanitizer_link_options INTERFACE "$<$<CONFIG:ASanAnd
 target_compile_options(default_sanitizer_compile_options INTERFACE "$<$<CXX_COMPILER_ID:AppleClang,Clang>:-fsanitize=local-bounds,float-divide-by-zero,implicit-conversion,nullability,integer>")
 target_link_options(default_sanitizer_link_options INTERFACE "$<$<CXX_COMPILER_ID:AppleClang,Clang>:-fsanitize=local-bounds,float-divide-by-zero,implicit-conversion,nullability,integer>")
 
+option(TRY_RANGES_INSTRUMENT "Count what the stages after instrument() pull" OFF)
+add_library(default_compile_definitions INTERFACE)
+target_compile_definitions(default_compile_definitions INTERFACE "$<$<BOOL:${TRY_RANGES_INSTRUMENT}>:TRY_RANGES_INSTRUMENT>")
+
 add_library(project_defaults INTERFACE)
 target_link_libraries(project_defaults INTERFACE
   default_compile_features
+  default_compile_definitions
   default_compile_options
   default_compile_warnings
   default_sanitizer_compile_options
@@ -10,7 +10,7 @@
 
       nativeBuildInputs = [ cmake ninja gdb valgrind ];
 
-      buildInputs = [ spdlog doctest boost175 range-v3 ];
+      buildInputs = [ spdlog doctest boost175 range-v3 gbenchmark ];
 
       doCheck = true;
       checkPhase = "ctest --output-on-failure";
@@ -0,0 +1,65 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+#include <memory>
+
+struct Arena::Block {
+  Block *next;
+  std::size_t size; // of the bytes after the header
+};
+
+Arena::Arena(std::size_t blockSize, std::pmr::memory_resource *upstream)
+    : upstream_(upstream),
+      nextBlockSize_(std::max<std::size_t>(blockSize, 1)) {}
+
+Arena::~Arena() { release(); }
+
+void Arena::reset() noexcept {
+  used_ = 0;
+  if (blocks_ == nullptr) {
+    return;
+  }
+  if (blocks_->next == nullptr) {
+    next_ = reinterpret_cast<std::byte *>(blocks_ + 1);
+    return;
+  }
+  // The merged block comes with the first allocation, as in a new arena
+  nextBlockSize_ = capacity_;
+  release();
+}
+
+void *Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  void *p = next_;
+  auto space = static_cast<std::size_t>(end_ - next_);
+  if (std::align(alignment, bytes, p, space) == nullptr) {
+    addBlock(bytes + alignment);
+    p = next_;
+    space = static_cast<std::size_t>(end_ - next_);
+    std::align(alignment, bytes, p, space);
+  }
+  next_ = static_cast<std::byte *>(p) + bytes;
+  used_ += bytes;
+  return p;
+}
+
+void Arena::addBlock(std::size_t size) {
+  size = std::max(size, nextBlockSize_);
+  void *p =
+      upstream_->allocate(sizeof(Block) + size, alignof(std::max_align_t));
+  blocks_ = ::new (p) Block{blocks_, size};
+  next_ = reinterpret_cast<std::byte *>(blocks_ + 1);
+  end_ = next_ + size;
+  capacity_ += size;
+  nextBlockSize_ = 2 * size;
+}
+
+void Arena::release() noexcept {
+  while (blocks_ != nullptr) {
+    Block *b = std::exchange(blocks_, blocks_->next);
+    upstream_->deallocate(b, sizeof(Block) + b->size,
+                          alignof(std::max_align_t));
+  }
+  next_ = nullptr;
+  end_ = nullptr;
+  capacity_ = 0;
+}
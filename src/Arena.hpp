@@ -0,0 +1,127 @@
+#pragma once
+
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+// A bump allocator for the results of one batch of work, say a request:
+// allocations just take the next bytes of a block, deallocations do
+// nothing, and reset() frees them all at once. Every block is twice as
+// large as the one before. One block is kept for the next batch, several
+// are merged into one as large as all of them, so once the arena has seen
+// its largest batch it no longer goes to the upstream resource. Not thread
+// safe, an arena per thread or per batch.
+class Arena : public std::pmr::memory_resource {
+public:
+  static constexpr std::size_t DefaultBlockSize = std::size_t{64} << 10U;
+
+  explicit Arena(
+      std::size_t blockSize = DefaultBlockSize,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  ~Arena() override;
+
+  // Makes all the memory given out free again. Nothing allocated from the
+  // arena, no container using it, may be used after this.
+  void reset() noexcept;
+
+  // The bytes given out since the last reset
+  [[nodiscard]] std::size_t used() const noexcept { return used_; }
+  // The bytes of all the blocks
+  [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+  struct Block;
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *, std::size_t, std::size_t) noexcept override {}
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  // A block of at least size bytes for the next allocations
+  void addBlock(std::size_t size);
+  void release() noexcept;
+
+  std::pmr::memory_resource *upstream_;
+  std::size_t nextBlockSize_;
+  Block *blocks_ = nullptr; // the current one, then the older ones
+  std::byte *next_ = nullptr;
+  std::byte *end_ = nullptr;
+  std::size_t used_ = 0;
+  std::size_t capacity_ = 0;
+};
+
+namespace detail {
+template <typename C>
+concept pmrContainer =
+    std::same_as<typename C::allocator_type,
+                 std::pmr::polymorphic_allocator<typename C::value_type>>;
+
+template <typename C, typename X> void append(C &c, X &&x) {
+  if constexpr (requires { c.emplace_back(std::forward<X>(x)); }) {
+    c.emplace_back(std::forward<X>(x));
+  } else if constexpr (requires {
+                       c.emplace_hint(c.end(), std::forward<X>(x));
+                     }) {
+    c.emplace_hint(c.end(), std::forward<X>(x));
+  } else {
+    c.insert(c.end(), std::forward<X>(x));
+  }
+}
+
+template <pmrContainer C, typename R>
+C toPmr(R &&rng, std::pmr::memory_resource &mr) {
+  using Value = typename C::value_type;
+  C c{typename C::allocator_type(&mr)};
+  if constexpr (ranges::sized_range<R> && requires { c.reserve(0); }) {
+    c.reserve(static_cast<typename C::size_type>(ranges::size(rng)));
+  }
+  for (auto &&x : rng) {
+    if constexpr (std::constructible_from<Value, decltype(x)>) {
+      append(c, std::forward<decltype(x)>(x));
+    } else {
+      // A range of ranges, a std::vector<std::string> say, into containers
+      // from mr all the way down
+      append(c, toPmr<Value>(x, mr));
+    }
+  }
+  return c;
+}
+
+template <pmrContainer C> struct ToPmrClosure {
+  std::pmr::memory_resource *mr;
+
+  template <ranges::input_range R> C operator()(R &&rng) const {
+    return toPmr<C>(std::forward<R>(rng), *mr);
+  }
+  template <ranges::input_range R>
+  friend C operator|(R &&rng, const ToPmrClosure &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+} // namespace detail
+
+// rg::to<C>, for a std::pmr container C allocating from mr, an Arena say.
+// Elements that are ranges but no C::value_type are converted to it the
+// same way, so nested pmr containers all use mr too.
+template <typename C, ranges::input_range R>
+  requires detail::pmrContainer<C>
+[[nodiscard]] C to_pmr(R &&rng, std::pmr::memory_resource &mr) {
+  return detail::toPmr<C>(std::forward<R>(rng), mr);
+}
+
+// rng | to_pmr<C>(mr)
+template <typename C>
+  requires detail::pmrContainer<C>
+[[nodiscard]] detail::ToPmrClosure<C> to_pmr(std::pmr::memory_resource &mr) {
+  return {&mr};
+}
@@ -0,0 +1,161 @@
+#include "Arena.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/view/transform.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+// new and delete, counted
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations = 0;
+  std::size_t live = 0;
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    ++live;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    --live;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+std::uintptr_t address(const void *p) {
+  return reinterpret_cast<std::uintptr_t>(p);
+}
+} // namespace
+
+TEST_CASE("Arena") {
+  SUBCASE("bumps through a block") {
+    CountingResource upstream;
+    Arena arena(1024, &upstream);
+    CHECK_EQ(arena.capacity(), 0);
+    auto *a = static_cast<std::byte *>(arena.allocate(10, 1));
+    auto *b = static_cast<std::byte *>(arena.allocate(10, 1));
+    CHECK_EQ(b, a + 10);
+    CHECK_EQ(address(arena.allocate(8, 64)) % 64, 0);
+    CHECK_EQ(upstream.allocations, 1);
+    CHECK_EQ(arena.capacity(), 1024);
+    arena.deallocate(a, 10, 1);
+    CHECK_EQ(arena.used(), 28);
+  }
+
+  SUBCASE("a reset reuses the memory") {
+    CountingResource upstream;
+    Arena arena(1024, &upstream);
+    void *first = arena.allocate(100);
+    arena.reset();
+    CHECK_EQ(arena.used(), 0);
+    CHECK_EQ(arena.allocate(100), first);
+    CHECK_EQ(upstream.allocations, 1);
+  }
+
+  SUBCASE("grown blocks are merged by a reset") {
+    CountingResource upstream;
+    Arena arena(128, &upstream);
+    for (int i = 0; i < 100; ++i) {
+      (void)arena.allocate(40);
+    }
+    CHECK_GT(upstream.allocations, 1);
+    const std::size_t capacity = arena.capacity();
+    CHECK_GE(capacity, 4000);
+    arena.reset();
+    CHECK_EQ(arena.capacity(), 0);
+    CHECK_EQ(upstream.live, 0);
+    for (int batch = 0; batch < 3; ++batch) {
+      for (int i = 0; i < 100; ++i) {
+        (void)arena.allocate(40);
+      }
+      arena.reset();
+    }
+    CHECK_EQ(arena.capacity(), capacity);
+    CHECK_EQ(upstream.live, 1);
+  }
+
+  SUBCASE("larger than a block") {
+    CountingResource upstream;
+    Arena arena(64, &upstream);
+    (void)arena.allocate(10);
+    void *p = arena.allocate(1000, 256);
+    CHECK_EQ(address(p) % 256, 0);
+    CHECK_GE(arena.capacity(), 1000);
+  }
+
+  SUBCASE("gives the blocks back") {
+    CountingResource upstream;
+    {
+      Arena arena(64, &upstream);
+      for (int i = 0; i < 10; ++i) {
+        (void)arena.allocate(100);
+      }
+    }
+    CHECK_EQ(upstream.live, 0);
+  }
+}
+
+TEST_CASE("to_pmr") {
+  CountingResource upstream;
+  Arena arena(Arena::DefaultBlockSize, &upstream);
+
+  SUBCASE("strings into a vector, all from the arena") {
+    const auto words = split_sv("a bb ccc dddd eeeee", ' ') |
+                       to_pmr<std::pmr::vector<std::pmr::string>>(arena);
+    const std::vector<std::string_view> expected = {"a", "bb", "ccc", "dddd",
+                                                    "eeeee"};
+    CHECK_UNARY(std::equal(words.begin(), words.end(), expected.begin(),
+                           expected.end()));
+    CHECK_EQ(words.get_allocator().resource(), &arena);
+    CHECK_EQ(words[4].get_allocator().resource(), &arena);
+    CHECK_EQ(upstream.allocations, 1);
+  }
+
+  SUBCASE("a view of chars into a string") {
+    const std::string_view s = "snake_case";
+    const auto upper =
+        to_pmr<std::pmr::string>(s | ranges::views::transform([](char c) {
+                                   return static_cast<char>(std::toupper(c));
+                                 }),
+                                 arena);
+    CHECK_EQ(upper, "SNAKE_CASE");
+    CHECK_EQ(upper.get_allocator().resource(), &arena);
+  }
+
+  SUBCASE("nested ranges are converted all the way down") {
+    const std::vector<std::vector<std::string>> table = {{"a", "b"}, {"c"}};
+    const auto t =
+        table |
+        to_pmr<std::pmr::vector<std::pmr::vector<std::pmr::string>>>(arena);
+    REQUIRE_EQ(t.size(), 2);
+    CHECK_EQ(t[0][1], "b");
+    CHECK_EQ(t[1][0], "c");
+    CHECK_EQ(t[0].get_allocator().resource(), &arena);
+    CHECK_EQ(t[0][1].get_allocator().resource(), &arena);
+  }
+
+  SUBCASE("sets") {
+    const std::vector<std::string_view> v = {"b", "a", "b"};
+    const auto set = v | to_pmr<std::pmr::set<std::pmr::string>>(arena);
+    const std::vector<std::string_view> expected = {"a", "b"};
+    CHECK_UNARY(
+        std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+  }
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <range/v3/functional/invoke.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/range/traits.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Batch execution of a pipeline: rng | batched(n) is a range of spans of n
+// elements at a time, and transform_batch and filter_batch then run their
+// function over a whole span in a plain loop, into a buffer reused from
+// batch to batch. So the compiler can vectorize the loop, and what every
+// view of a pipeline costs per element is paid once per batch instead.
+// rv::join, or a loop over the spans, gets the elements back. A span is
+// valid until the next ++ of the range it came from.
+
+inline constexpr std::size_t defaultBatchSize = 1024;
+
+namespace detail {
+template <typename R>
+using batchElement =
+    typename std::remove_cvref_t<ranges::range_reference_t<R>>::element_type;
+
+template <typename R>
+concept batchRange =
+    ranges::input_range<R> &&
+    std::same_as<std::remove_cvref_t<ranges::range_reference_t<R>>,
+                 std::span<batchElement<R>>>;
+} // namespace detail
+
+// The elements of V as spans of n, the last one shorter. Those of a
+// contiguous V are spans into it, others are copied into a buffer first.
+template <typename V>
+  requires ranges::input_range<V> && ranges::view_<V>
+class batched_view : public ranges::view_interface<batched_view<V>> {
+  using T = std::remove_cvref_t<ranges::range_reference_t<V>>;
+  static constexpr bool Contiguous =
+      ranges::contiguous_range<V> && ranges::sized_range<V>;
+
+public:
+  class iterator {
+  public:
+    using value_type = std::span<const T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::span<const T> operator*() const { return batch_; }
+    iterator &operator++() {
+      next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return it.batch_.empty();
+    }
+
+  private:
+    friend batched_view;
+    explicit iterator(batched_view &parent) : parent_(&parent) {
+      if constexpr (!Contiguous) {
+        it_ = ranges::begin(parent.base_);
+      }
+      next();
+    }
+
+    void next() {
+      auto &p = *parent_;
+      if constexpr (Contiguous) {
+        const auto *data = ranges::data(p.base_);
+        const auto size = static_cast<std::size_t>(ranges::size(p.base_));
+        const std::size_t first = std::min(pos_, size);
+        pos_ = std::min(first + p.n_, size);
+        batch_ = {data + first, pos_ - first};
+      } else {
+        p.buffer_.clear();
+        for (; p.buffer_.size() < p.n_ && *it_ != ranges::end(p.base_);
+             ++*it_) {
+          p.buffer_.push_back(**it_);
+        }
+        batch_ = p.buffer_;
+      }
+    }
+
+    batched_view *parent_ = nullptr;
+    std::optional<ranges::iterator_t<V>> it_;
+    std::size_t pos_ = 0;
+    std::span<const T> batch_;
+  };
+
+  batched_view() = default;
+  batched_view(V base, std::size_t n) : base_(std::move(base)), n_(n) {
+    if (n == 0) {
+      throw std::invalid_argument("batched: batches of no elements");
+    }
+  }
+
+  [[nodiscard]] iterator begin() { return iterator(*this); }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  V base_;
+  std::size_t n_ = defaultBatchSize;
+  std::vector<T> buffer_;
+};
+
+// The batches of a batched range of V, each through Stage: stage(in, out)
+// fills out from the span in and returns the span of out to pass on.
+// Batches that come out empty are skipped.
+template <typename V, typename Stage>
+  requires detail::batchRange<V> && ranges::view_<V>
+class batch_stage_view
+    : public ranges::view_interface<batch_stage_view<V, Stage>> {
+  using In = detail::batchElement<V>;
+  using Out = typename Stage::template output<std::remove_const_t<In>>;
+
+public:
+  class iterator {
+  public:
+    using value_type = std::span<const Out>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::span<const Out> operator*() const { return batch_; }
+    iterator &operator++() {
+      ++it_;
+      next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return it.done_;
+    }
+
+  private:
+    friend batch_stage_view;
+    explicit iterator(batch_stage_view &parent)
+        : parent_(&parent), it_(ranges::begin(parent.base_)) {
+      next();
+    }
+
+    void next() {
+      auto &p = *parent_;
+      for (; it_ != ranges::end(p.base_); ++it_) {
+        batch_ = p.stage_(std::span<const In>(*it_), p.buffer_);
+        if (!batch_.empty()) {
+          return;
+        }
+      }
+      done_ = true;
+    }
+
+    batch_stage_view *parent_ = nullptr;
+    ranges::iterator_t<V> it_;
+    std::span<const Out> batch_;
+    bool done_ = false;
+  };
+
+  batch_stage_view() = default;
+  batch_stage_view(V base, Stage stage)
+      : base_(std::move(base)), stage_(std::move(stage)) {}
+
+  [[nodiscard]] iterator begin() { return iterator(*this); }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  V base_;
+  Stage stage_;
+  std::vector<Out> buffer_;
+};
+
+namespace detail {
+template <typename F> struct TransformStage {
+  template <typename T>
+  using output = std::remove_cvref_t<std::invoke_result_t<F &, const T &>>;
+
+  F f;
+
+  template <typename T, typename U>
+  std::span<const U> operator()(std::span<const T> in, std::vector<U> &out) {
+    out.resize(in.size());
+    U *o = out.data();
+    for (std::size_t i = 0; i < in.size(); ++i) {
+      o[i] = ranges::invoke(f, in[i]);
+    }
+    return {o, in.size()};
+  }
+};
+
+// Every element is copied, and kept by moving on past it, so the loop has
+// no branch
+template <typename Pred> struct FilterStage {
+  template <typename T> using output = T;
+
+  Pred pred;
+
+  template <typename T>
+  std::span<const T> operator()(std::span<const T> in, std::vector<T> &out) {
+    out.resize(in.size());
+    T *o = out.data();
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < in.size(); ++i) {
+      o[k] = in[i];
+      k += ranges::invoke(pred, in[i]) ? 1U : 0U;
+    }
+    return {o, k};
+  }
+};
+
+struct BatchedFn {
+  std::size_t n;
+
+  template <ranges::input_range R> auto operator()(R &&rng) const {
+    return batched_view<ranges::views::all_t<R>>(
+        ranges::views::all(std::forward<R>(rng)), n);
+  }
+  template <ranges::input_range R>
+  friend auto operator|(R &&rng, const BatchedFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+
+template <typename Stage> struct BatchStageFn {
+  Stage stage;
+
+  template <batchRange R> auto operator()(R &&rng) const {
+    return batch_stage_view<ranges::views::all_t<R>, Stage>(
+        ranges::views::all(std::forward<R>(rng)), stage);
+  }
+  template <batchRange R>
+  friend auto operator|(R &&rng, const BatchStageFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+} // namespace detail
+
+// rng | batched(n), std::invalid_argument for n == 0
+[[nodiscard]] inline detail::BatchedFn
+batched(std::size_t n = defaultBatchSize) {
+  return {n};
+}
+
+// batches | transform_batch(f), f of every element, batch by batch
+template <typename F>
+[[nodiscard]] detail::BatchStageFn<detail::TransformStage<F>>
+transform_batch(F f) {
+  return {{std::move(f)}};
+}
+
+// batches | filter_batch(pred), the elements with pred, batch by batch
+template <typename Pred>
+[[nodiscard]] detail::BatchStageFn<detail::FilterStage<Pred>>
+filter_batch(Pred pred) {
+  return {{std::move(pred)}};
+}
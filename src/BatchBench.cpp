@@ -0,0 +1,56 @@
+#include "Batch.hpp"
+#include "Bench.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> randomFloats(const benchmark::State &state) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(0, 100);
+  std::vector<float> v(bench::inputSize(state) / sizeof(float));
+  std::generate(v.begin(), v.end(), [&] { return dist(gen); });
+  return v;
+}
+
+const auto scale = [](float x) { return 1.5F * x + 1.0F; };
+const auto large = [](float x) { return x > 75.0F; };
+
+// The sum of the large scaled elements, through views per element
+void BM_pipelineViews(benchmark::State &state) {
+  const auto v = randomFloats(state);
+  for (auto _ : state) {
+    float sum = 0;
+    for (const float x :
+         v | ranges::views::transform(scale) | ranges::views::filter(large)) {
+      sum += x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_pipelineBatched(benchmark::State &state) {
+  const auto v = randomFloats(state);
+  for (auto _ : state) {
+    float sum = 0;
+    for (const auto batch : v | batched() | transform_batch(scale) |
+                                filter_batch(large)) {
+      for (const float x : batch) {
+        sum += x;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  bench::setBytesProcessed(state);
+}
+} // namespace
+
+BENCHMARK(BM_pipelineViews)->Apply(bench::inputSizes);
+BENCHMARK(BM_pipelineBatched)->Apply(bench::inputSizes);
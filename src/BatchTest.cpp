@@ -0,0 +1,93 @@
+#include "Batch.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/join.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<int> iota(int n) {
+  std::vector<int> v(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    v[static_cast<std::size_t>(i)] = i;
+  }
+  return v;
+}
+
+template <typename R> std::vector<std::size_t> batchSizes(R &&batches) {
+  std::vector<std::size_t> sizes;
+  for (const auto batch : batches) {
+    sizes.push_back(batch.size());
+  }
+  return sizes;
+}
+} // namespace
+
+TEST_CASE("batched") {
+  const auto v = iota(2500);
+  const std::vector<std::size_t> sizes = {1024, 1024, 452};
+
+  SUBCASE("spans into a contiguous range") {
+    auto batches = v | batched();
+    CHECK_EQ(batchSizes(batches), sizes);
+    auto it = batches.begin();
+    ++it;
+    CHECK_EQ((*it).data(), v.data() + 1024);
+  }
+
+  SUBCASE("others are copied") {
+    auto doubled = v | ranges::views::transform([](int x) { return 2 * x; }) |
+                   batched(1024);
+    CHECK_EQ(batchSizes(doubled), sizes);
+    auto halves = v | ranges::views::filter([](int x) { return x % 2 == 0; }) |
+                  batched(1000);
+    const std::vector<std::size_t> halfSizes = {1000, 250};
+    CHECK_EQ(batchSizes(halves), halfSizes);
+  }
+
+  SUBCASE("empty") {
+    const std::vector<int> none;
+    CHECK_UNARY(batchSizes(none | batched()).empty());
+    CHECK_THROWS_AS(v | batched(0), std::invalid_argument);
+  }
+}
+
+TEST_CASE("transform_batch and filter_batch") {
+  const auto v = iota(5000);
+
+  SUBCASE("the same elements as the views per element") {
+    const auto square = [](int x) { return static_cast<long>(x) * x; };
+    const auto odd = [](long x) { return x % 2 == 1; };
+    auto batches = v | batched(100) | transform_batch(square) |
+                   filter_batch(odd);
+    const auto flat = batches | ranges::views::join | ranges::to<std::vector>();
+    auto elementwise = v | ranges::views::transform(square) |
+                       ranges::views::filter(odd);
+    const auto expected = elementwise | ranges::to<std::vector>();
+    CHECK_EQ(flat, expected);
+  }
+
+  SUBCASE("batches filtered empty are skipped") {
+    auto batches = v | batched(100) |
+                   filter_batch([](int x) { return x < 50 || x >= 4950; });
+    const std::vector<std::size_t> sizes = {50, 50};
+    CHECK_EQ(batchSizes(batches), sizes);
+    auto none = v | batched(100) | filter_batch([](int) { return false; });
+    CHECK_UNARY(none.begin() == none.end());
+  }
+
+  SUBCASE("types change along the way") {
+    auto halves = v | batched() |
+                  transform_batch([](int x) { return x / 2.0; }) |
+                  filter_batch([](double x) { return x >= 2499; });
+    const auto flat = halves | ranges::views::join | ranges::to<std::vector>();
+    const std::vector expected = {2499.0, 2499.5};
+    CHECK_EQ(flat, expected);
+  }
+}
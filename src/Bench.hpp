@@ -0,0 +1,44 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace bench {
+// Input sizes in bytes, 1 KiB to 1 GiB
+inline void inputSizes(benchmark::internal::Benchmark *b) {
+  b->RangeMultiplier(32)->Range(std::int64_t{1} << 10, std::int64_t{1} << 30);
+}
+
+[[nodiscard]] inline std::size_t inputSize(const benchmark::State &state) {
+  return static_cast<std::size_t>(state.range(0));
+}
+
+inline void setBytesProcessed(benchmark::State &state) {
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// size bytes of lines made by line(gen), each followed by '\n'
+template <typename F> std::string makeLines(std::size_t size, F line) {
+  std::mt19937 gen(size);
+  std::string s;
+  s.reserve(size);
+  while (s.size() < size) {
+    s += line(gen);
+    s.push_back('\n');
+  }
+  s.resize(size);
+  return s;
+}
+
+// Log-like text, lines of 0 to 160 chars
+inline std::string makeLines(std::size_t size) {
+  return makeLines(size, [](std::mt19937 &gen) {
+    return std::string(std::uniform_int_distribution<std::size_t>(0, 160)(gen),
+                       'x');
+  });
+}
+} // namespace bench
@@ -0,0 +1,57 @@
+#include "BitPack.hpp"
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+static_assert(simd::BlockSize == 64, "a block of flags is one word");
+
+namespace {
+// Bits in reverse order, the swaps of halves, quarters, ... of the word
+std::uint64_t reverseBits(std::uint64_t x) noexcept {
+  x = ((x >> 1U) & 0x5555555555555555U) | ((x & 0x5555555555555555U) << 1U);
+  x = ((x >> 2U) & 0x3333333333333333U) | ((x & 0x3333333333333333U) << 2U);
+  x = ((x >> 4U) & 0x0F0F0F0F0F0F0F0FU) | ((x & 0x0F0F0F0F0F0F0F0FU) << 4U);
+  return __builtin_bswap64(x);
+}
+} // namespace
+
+// A block of 64 flags is one matchMask against 0, i.e. a movemask of the
+// compared bytes, inverted
+std::span<std::uint64_t> packBits(std::span<const std::uint8_t> bits,
+                                  std::span<std::uint64_t> out) {
+  const std::size_t words = packedWords(bits.size());
+  if (out.size() < words) {
+    throw std::length_error("packBits: output too short");
+  }
+  const simd::MatchMaskFn mask = simd::matchMask();
+  const auto *p = reinterpret_cast<const char *>(bits.data());
+  for (std::size_t w = 0; w < words; ++w) {
+    const std::size_t n = std::min(simd::BlockSize, bits.size() - w * 64);
+    const std::uint64_t used =
+        n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+    out[w] = ~simd::detail::partialMask(
+                 p + w * 64, n,
+                 [mask](const char *block) { return mask(block, '\0'); }) &
+             used;
+  }
+  return out.first(words);
+}
+
+std::vector<std::uint64_t> packBits(std::span<const std::uint8_t> bits) {
+  std::vector<std::uint64_t> words(packedWords(bits.size()));
+  packBits(bits, words);
+  return words;
+}
+
+std::uint64_t bitsToInt(std::span<const std::uint8_t> bits) {
+  if (bits.size() > 64) {
+    throw std::length_error("bitsToInt: more than 64 bits");
+  }
+  if (bits.empty()) {
+    return 0;
+  }
+  std::uint64_t word = 0;
+  packBits(bits, std::span(&word, 1));
+  return reverseBits(word) >> (64 - bits.size());
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Byte per bit flags, as 0 or non zero bytes, packed into 64 bit words: bit
+// i % 64 of word i / 64 is flag i, the unused bits of the last word are 0.
+
+[[nodiscard]] constexpr std::size_t packedWords(std::size_t bits) noexcept {
+  return (bits + 63) / 64;
+}
+
+// Writes packedWords(bits.size()) words to the front of out and returns
+// them, std::length_error is thrown if out is shorter
+std::span<std::uint64_t> packBits(std::span<const std::uint8_t> bits,
+                                  std::span<std::uint64_t> out);
+[[nodiscard]] std::vector<std::uint64_t>
+packBits(std::span<const std::uint8_t> bits);
+
+// The number the flags spell, most significant first: {1, 1, 1, 0} is 14.
+// More than 64 flags throw std::length_error instead of overflowing.
+[[nodiscard]] std::uint64_t bitsToInt(std::span<const std::uint8_t> bits);
+
+// Streams the packed words of any input range of flags, for sequences that
+// are not in memory at once. Contiguous bytes are faster with packBits.
+template <typename V>
+  requires ranges::input_range<V> && ranges::view_<V>
+class packed_bits_view : public ranges::view_interface<packed_bits_view<V>> {
+public:
+  class iterator {
+  public:
+    using value_type = std::uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::uint64_t operator*() const { return word_; }
+    iterator &operator++() {
+      read();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &i, std::default_sentinel_t) {
+      return i.done_;
+    }
+
+  private:
+    friend packed_bits_view;
+    iterator(ranges::iterator_t<V> it, ranges::sentinel_t<V> end)
+        : it_(std::move(it)), end_(std::move(end)) {
+      read();
+    }
+
+    void read() {
+      done_ = it_ == end_;
+      word_ = 0;
+      for (unsigned i = 0; i < 64 && it_ != end_; ++i, ++it_) {
+        word_ |= std::uint64_t{*it_ != 0} << i;
+      }
+    }
+
+    ranges::iterator_t<V> it_{};
+    ranges::sentinel_t<V> end_{};
+    std::uint64_t word_ = 0;
+    bool done_ = true;
+  };
+
+  packed_bits_view() = default;
+  explicit packed_bits_view(V base) : base_(std::move(base)) {}
+
+  [[nodiscard]] iterator begin() {
+    return {ranges::begin(base_), ranges::end(base_)};
+  }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  V base_;
+};
+
+namespace detail {
+struct PackedBitsFn {
+  template <typename R> auto operator()(R &&rng) const {
+    return packed_bits_view<ranges::views::all_t<R>>(
+        ranges::views::all(std::forward<R>(rng)));
+  }
+  template <typename R>
+  friend auto operator|(R &&rng, const PackedBitsFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+} // namespace detail
+
+// flags | packed_bits, the packed words of a range of flags
+inline constexpr detail::PackedBitsFn packed_bits;
@@ -0,0 +1,92 @@
+#include "BitPack.hpp"
+#include "Simd.hpp"
+#include "SimdTestSupport.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/istream.hpp>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<std::uint8_t> randomFlags(std::size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, 3);
+  std::vector<std::uint8_t> v(n);
+  for (auto &b : v) {
+    // Any non zero byte is a set flag
+    b = static_cast<std::uint8_t>(dist(gen) == 0 ? 0 : dist(gen) * 50 + 1);
+  }
+  return v;
+}
+
+std::vector<std::uint64_t> packSlowly(const std::vector<std::uint8_t> &v) {
+  std::vector<std::uint64_t> words((v.size() + 63) / 64);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    words[i / 64] |= std::uint64_t{v[i] != 0} << (i % 64);
+  }
+  return words;
+}
+} // namespace
+
+TEST_CASE("bitsToInt") {
+  SUBCASE("Binary to decimal conversion, 0b1110 = 14") {
+    const std::vector<std::uint8_t> v = {1, 1, 1, 0};
+    CHECK_EQ(bitsToInt(v), 14);
+  }
+  SUBCASE("up to 64 bits") {
+    CHECK_EQ(bitsToInt({}), 0);
+    const std::vector<std::uint8_t> ones(64, 1);
+    CHECK_EQ(bitsToInt(ones), ~std::uint64_t{0});
+    std::vector<std::uint8_t> top(64, 0);
+    top[0] = 1;
+    CHECK_EQ(bitsToInt(top), std::uint64_t{1} << 63U);
+    CHECK_EQ(bitsToInt(std::span(top).first(33)), std::uint64_t{1} << 32U);
+  }
+  SUBCASE("does not overflow silently") {
+    const std::vector<std::uint8_t> v(65, 1);
+    CHECK_THROWS_AS((void)bitsToInt(v), std::length_error);
+  }
+}
+
+TEST_CASE("packBits") {
+  forEachIsa([&](simd::Isa) {
+    for (const std::size_t n : {0U, 1U, 63U, 64U, 65U, 1000U, 4096U}) {
+      const auto v = randomFlags(n, static_cast<unsigned>(n));
+      CHECK_EQ(packBits(v), packSlowly(v));
+    }
+  });
+  SUBCASE("into a caller buffer") {
+    const auto v = randomFlags(130, 1);
+    std::array<std::uint64_t, 4> out{};
+    CHECK_EQ(packBits(v, out).size(), 3);
+    CHECK_EQ(out[0], packSlowly(v)[0]);
+    CHECK_EQ(out[3], 0);
+    std::array<std::uint64_t, 2> small{};
+    CHECK_THROWS_AS(packBits(v, small), std::length_error);
+  }
+}
+
+TEST_CASE("packed_bits") {
+  SUBCASE("same words as packBits") {
+    const auto v = randomFlags(1000, 2);
+    CHECK_EQ(v | packed_bits | ranges::to<std::vector<std::uint64_t>>(),
+             packBits(v));
+    const std::vector<std::uint8_t> empty;
+    auto none = empty | packed_bits;
+    CHECK_UNARY(none.begin() == none.end());
+  }
+  SUBCASE("streams an input range") {
+    std::istringstream in("1 0 1 1");
+    auto words = ranges::istream_view<int>(in) | packed_bits;
+    auto it = words.begin();
+    CHECK_EQ(*it, 0b1101);
+    CHECK_UNARY(++it == words.end());
+  }
+}
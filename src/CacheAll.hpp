@@ -0,0 +1,201 @@
+#pragma once
+
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <compare>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail {
+// Elements of a cache_all_view are computed this many at a time
+inline constexpr std::size_t cacheAllChunk = 64;
+} // namespace detail
+
+// Every element of V computed once, the opposite tradeoff to views::cache1:
+// for an expensive views::transform, say, read more than once, by a find
+// and then a loop from what it found, or the windows of a sliding. The
+// elements are computed in order, a chunk at a time up to the one read,
+// into a buffer of values that is reserved up front when V is sized, so
+// the references stay valid. The view is random access then, otherwise
+// forward even if V is only an input range, and copies share the buffer.
+template <typename V>
+  requires ranges::input_range<V> && ranges::view_<V>
+class cache_all_view : public ranges::view_interface<cache_all_view<V>> {
+  using T = std::remove_cvref_t<ranges::range_reference_t<V>>;
+  static constexpr bool Sized = ranges::sized_range<V>;
+
+  struct State {
+    V base;
+    std::optional<ranges::iterator_t<V>> next;
+    std::conditional_t<Sized, std::vector<T>, std::deque<T>> values;
+    std::size_t size = 0;
+
+    explicit State(V v) : base(std::move(v)) {
+      if constexpr (Sized) {
+        size = static_cast<std::size_t>(ranges::size(base));
+        values.reserve(size);
+      }
+    }
+
+    // Computes the elements up to the chunk of i, false if V has none i
+    bool fill(std::size_t i) {
+      if (i < values.size()) {
+        return true;
+      }
+      if (!next) {
+        next = ranges::begin(base);
+      }
+      const std::size_t stop =
+          (i / detail::cacheAllChunk + 1) * detail::cacheAllChunk;
+      for (; values.size() < stop && *next != ranges::end(base); ++*next) {
+        values.push_back(**next);
+      }
+      return i < values.size();
+    }
+
+    const T &at(std::size_t i) {
+      fill(i);
+      return values[i];
+    }
+  };
+
+public:
+  class iterator {
+  public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept =
+        std::conditional_t<Sized, std::random_access_iterator_tag,
+                           std::forward_iterator_tag>;
+    using iterator_category = iterator_concept;
+
+    iterator() = default;
+
+    const T &operator*() const { return state_->at(i_); }
+    const T *operator->() const { return std::addressof(**this); }
+    const T &operator[](difference_type n) const
+      requires Sized
+    {
+      return *(*this + n);
+    }
+
+    iterator &operator++() {
+      ++i_;
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    iterator &operator--()
+      requires Sized
+    {
+      --i_;
+      return *this;
+    }
+    iterator operator--(int)
+      requires Sized
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+    iterator &operator+=(difference_type n)
+      requires Sized
+    {
+      i_ = static_cast<std::size_t>(static_cast<difference_type>(i_) + n);
+      return *this;
+    }
+    iterator &operator-=(difference_type n)
+      requires Sized
+    {
+      return *this += -n;
+    }
+    friend iterator operator+(iterator it, difference_type n)
+      requires Sized
+    {
+      return it += n;
+    }
+    friend iterator operator+(difference_type n, iterator it)
+      requires Sized
+    {
+      return it += n;
+    }
+    friend iterator operator-(iterator it, difference_type n)
+      requires Sized
+    {
+      return it -= n;
+    }
+    friend difference_type operator-(const iterator &a, const iterator &b)
+      requires Sized
+    {
+      return static_cast<difference_type>(a.i_) -
+             static_cast<difference_type>(b.i_);
+    }
+
+    friend bool operator==(const iterator &a, const iterator &b) {
+      return a.i_ == b.i_;
+    }
+    friend std::strong_ordering operator<=>(const iterator &a,
+                                            const iterator &b) {
+      return a.i_ <=> b.i_;
+    }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return !it.state_->fill(it.i_);
+    }
+
+  private:
+    friend cache_all_view;
+    iterator(State *state, std::size_t i) : state_(state), i_(i) {}
+
+    State *state_ = nullptr;
+    std::size_t i_ = 0;
+  };
+
+  cache_all_view() = default;
+  explicit cache_all_view(V base)
+      : state_(std::make_shared<State>(std::move(base))) {}
+
+  [[nodiscard]] iterator begin() const { return {state_.get(), 0}; }
+  [[nodiscard]] auto end() const {
+    if constexpr (Sized) {
+      return iterator(state_.get(), size());
+    } else {
+      return std::default_sentinel;
+    }
+  }
+  [[nodiscard]] std::size_t size() const
+    requires Sized
+  {
+    return state_->size;
+  }
+
+private:
+  std::shared_ptr<State> state_;
+};
+
+namespace detail {
+struct CacheAllFn {
+  template <typename R> auto operator()(R &&rng) const {
+    return cache_all_view<ranges::views::all_t<R>>(
+        ranges::views::all(std::forward<R>(rng)));
+  }
+  template <typename R> friend auto operator|(R &&rng, const CacheAllFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+} // namespace detail
+
+// rng | cache_all, or cache_all(rng)
+inline constexpr detail::CacheAllFn cache_all;
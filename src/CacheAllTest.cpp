@@ -0,0 +1,112 @@
+#include "CacheAll.hpp"
+#include "Generator.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/algorithm/find.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<int> iota(int n) {
+  std::vector<int> v(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    v[static_cast<std::size_t>(i)] = i;
+  }
+  return v;
+}
+
+generator<int> squares(int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i * i;
+  }
+}
+} // namespace
+
+TEST_CASE("cache_all") {
+  SUBCASE("every element computed once") {
+    const auto v = iota(1000);
+    std::size_t calls = 0;
+    auto cached = v | ranges::views::transform([&](int x) {
+                    ++calls;
+                    return std::to_string(x);
+                  }) |
+                  cache_all;
+    static_assert(ranges::random_access_range<decltype(cached)>);
+    static_assert(ranges::common_range<decltype(cached)>);
+    REQUIRE_EQ(cached.size(), 1000);
+
+    const auto it = ranges::find(cached, "700");
+    REQUIRE_NE(it, cached.end());
+    CHECK_EQ(it - cached.begin(), 700);
+    std::size_t n = 0;
+    for (auto i = it; i != cached.end(); ++i) {
+      n += i->size();
+    }
+    CHECK_EQ(n, 3 * 300);
+    CHECK_EQ(cached[3], "3");
+    CHECK_EQ(*(cached.end() - 1), "999");
+    CHECK_EQ(calls, 1000);
+  }
+
+  SUBCASE("only up to the chunk read") {
+    const auto v = iota(1000);
+    std::size_t calls = 0;
+    auto cached = v | ranges::views::transform([&](int x) {
+                    ++calls;
+                    return x;
+                  }) |
+                  cache_all;
+    CHECK_EQ(cached[1], 1);
+    CHECK_EQ(calls, detail::cacheAllChunk);
+    // References stay valid as the rest is computed
+    const int &first = cached[0];
+    CHECK_EQ(cached[999], 999);
+    CHECK_EQ(first, 0);
+    CHECK_EQ(calls, 1000);
+  }
+
+  SUBCASE("copies share the cache") {
+    const auto v = iota(10);
+    std::size_t calls = 0;
+    const auto cached = v | ranges::views::transform([&](int x) {
+                          ++calls;
+                          return x * 2;
+                        }) |
+                        cache_all;
+    const auto copy = cached;
+    CHECK_EQ(cached[9], 18);
+    CHECK_EQ(copy[9], 18);
+    CHECK_EQ(calls, 10);
+  }
+
+  SUBCASE("an input range made multi pass") {
+    auto g = squares(200);
+    auto cached = cache_all(g);
+    static_assert(ranges::forward_range<decltype(cached)>);
+    static_assert(!ranges::sized_range<decltype(cached)>);
+    int sum = 0;
+    for (const int x : cached) {
+      sum += x;
+    }
+    int again = 0;
+    for (const int x : cached) {
+      again += x;
+    }
+    CHECK_EQ(sum, 199 * 200 * 399 / 6);
+    CHECK_EQ(again, sum);
+  }
+
+  SUBCASE("empty") {
+    const std::vector<int> v;
+    auto cached = v | cache_all;
+    CHECK_UNARY(cached.begin() == cached.end());
+    auto g = squares(0);
+    auto none = g | cache_all;
+    CHECK_UNARY(none.begin() == none.end());
+  }
+}
@@ -0,0 +1,126 @@
+#include "CaseConvert.hpp"
+
+#include "Simd.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+// The separators and upper case letters are located with the SIMD block
+// scanners, the runs between them are copied with memcpy, and only the one
+// char at each word boundary changes case.
+
+namespace {
+constexpr char toUpper(char c) noexcept {
+  return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+constexpr char toLower(char c) noexcept {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// memcpy must not see the null data() of empty views
+void copy(char *dst, const char *src, std::size_t n) noexcept {
+  if (n != 0) {
+    std::memcpy(dst, src, n);
+  }
+}
+
+void checkFits(std::size_t size, std::span<char> out) {
+  if (out.size() < size) {
+    throw std::length_error("case conversion: output too short");
+  }
+}
+
+std::size_t separatedToCamelSize(std::string_view in, char sep) noexcept {
+  return in.size() - simd::count(in, sep);
+}
+
+std::size_t separatedToCamel(std::string_view in, char sep,
+                             std::span<char> out) {
+  checkFits(separatedToCamelSize(in, sep), out);
+  std::size_t w = 0;
+  const auto word = [&](std::size_t first, std::size_t last) {
+    if (first == last) {
+      return;
+    }
+    out[w] = toUpper(in[first]);
+    copy(out.data() + w + 1, in.data() + first + 1, last - first - 1);
+    w += last - first;
+  };
+  std::size_t prev = 0;
+  simd::forEachMatch(in, sep, [&](std::size_t pos) {
+    word(prev, pos);
+    prev = pos + 1;
+  });
+  word(prev, in.size());
+  return w;
+}
+
+std::size_t upperAfterFirst(std::string_view in) noexcept {
+  std::size_t n = 0;
+  simd::forEachInRange(in, 'A', 'Z', [&](std::size_t pos) { n += pos != 0; });
+  return n;
+}
+
+std::size_t camelToSeparated(std::string_view in, char sep,
+                             std::span<char> out) {
+  checkFits(in.size() + upperAfterFirst(in), out);
+  std::size_t w = 0;
+  std::size_t prev = 0;
+  simd::forEachInRange(in, 'A', 'Z', [&](std::size_t pos) {
+    copy(out.data() + w, in.data() + prev, pos - prev);
+    w += pos - prev;
+    if (pos != 0) {
+      out[w++] = sep;
+    }
+    out[w++] = toLower(in[pos]);
+    prev = pos + 1;
+  });
+  copy(out.data() + w, in.data() + prev, in.size() - prev);
+  return w + in.size() - prev;
+}
+
+} // namespace
+
+std::size_t snakeToCamelSize(std::string_view in) noexcept {
+  return separatedToCamelSize(in, '_');
+}
+std::size_t snakeToCamel(std::string_view in, std::span<char> out) {
+  return separatedToCamel(in, '_', out);
+}
+void snakeToCamel(std::string_view in, std::string &out) {
+  out.resize(snakeToCamelSize(in));
+  separatedToCamel(in, '_', out);
+}
+
+std::size_t kebabToCamelSize(std::string_view in) noexcept {
+  return separatedToCamelSize(in, '-');
+}
+std::size_t kebabToCamel(std::string_view in, std::span<char> out) {
+  return separatedToCamel(in, '-', out);
+}
+void kebabToCamel(std::string_view in, std::string &out) {
+  out.resize(kebabToCamelSize(in));
+  separatedToCamel(in, '-', out);
+}
+
+std::size_t camelToSnakeSize(std::string_view in) noexcept {
+  return in.size() + upperAfterFirst(in);
+}
+std::size_t camelToSnake(std::string_view in, std::span<char> out) {
+  return camelToSeparated(in, '_', out);
+}
+void camelToSnake(std::string_view in, std::string &out) {
+  out.resize(camelToSnakeSize(in));
+  camelToSeparated(in, '_', out);
+}
+
+std::size_t camelToKebabSize(std::string_view in) noexcept {
+  return camelToSnakeSize(in);
+}
+std::size_t camelToKebab(std::string_view in, std::span<char> out) {
+  return camelToSeparated(in, '-', out);
+}
+void camelToKebab(std::string_view in, std::string &out) {
+  out.resize(camelToKebabSize(in));
+  camelToSeparated(in, '-', out);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Identifier case conversion between snake_case, kebab-case and CamelCase.
+// Every function comes in two forms: one resizes a caller owned string, so
+// its capacity is reused across calls, the other writes into a span and
+// returns the number of chars written, throwing std::length_error if the
+// span is too short. The *Size functions give the exact output size.
+//
+// CamelCase -> snake/kebab starts a new word at every ASCII upper case
+// letter but the first, so "HTTPServer" becomes "h_t_t_p_server".
+// snake/kebab -> CamelCase upper cases the first char of every word and
+// drops empty words, as the snake_case to CamelCase range test does.
+
+[[nodiscard]] std::size_t snakeToCamelSize(std::string_view in) noexcept;
+std::size_t snakeToCamel(std::string_view in, std::span<char> out);
+void snakeToCamel(std::string_view in, std::string &out);
+
+[[nodiscard]] std::size_t kebabToCamelSize(std::string_view in) noexcept;
+std::size_t kebabToCamel(std::string_view in, std::span<char> out);
+void kebabToCamel(std::string_view in, std::string &out);
+
+[[nodiscard]] std::size_t camelToSnakeSize(std::string_view in) noexcept;
+std::size_t camelToSnake(std::string_view in, std::span<char> out);
+void camelToSnake(std::string_view in, std::string &out);
+
+[[nodiscard]] std::size_t camelToKebabSize(std::string_view in) noexcept;
+std::size_t camelToKebab(std::string_view in, std::span<char> out);
+void camelToKebab(std::string_view in, std::string &out);
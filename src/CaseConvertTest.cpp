@@ -0,0 +1,71 @@
+#include "CaseConvert.hpp"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+template <typename Convert>
+std::string convert(std::string_view in, Convert f) {
+  std::string out;
+  f(in, out);
+  return out;
+}
+
+void snake(std::string_view in, std::string &out) { snakeToCamel(in, out); }
+void kebab(std::string_view in, std::string &out) { kebabToCamel(in, out); }
+void toSnake(std::string_view in, std::string &out) { camelToSnake(in, out); }
+void toKebab(std::string_view in, std::string &out) { camelToKebab(in, out); }
+} // namespace
+
+TEST_CASE("snakeToCamel and kebabToCamel") {
+  CHECK_EQ(convert("feel_the_force", snake), "FeelTheForce");
+  CHECK_EQ(convert("feel-the-force", kebab), "FeelTheForce");
+  CHECK_EQ(convert("", snake), "");
+  CHECK_EQ(convert("_", snake), "");
+  CHECK_EQ(convert("__a__b_", snake), "AB");
+  CHECK_EQ(convert("x1_2y", snake), "X12y");
+  CHECK_EQ(convert("already_Upper", snake), "AlreadyUpper");
+  CHECK_EQ(snakeToCamelSize("feel_the_force"), 12);
+
+  SUBCASE("long identifiers cross scan blocks") {
+    std::string in;
+    std::string expected;
+    for (int i = 0; i < 40; ++i) {
+      in += "word_";
+      expected += "Word";
+    }
+    CHECK_EQ(convert(in, snake), expected);
+  }
+}
+
+TEST_CASE("camelToSnake and camelToKebab") {
+  CHECK_EQ(convert("FeelTheForce", toSnake), "feel_the_force");
+  CHECK_EQ(convert("feelTheForce", toKebab), "feel-the-force");
+  CHECK_EQ(convert("", toSnake), "");
+  CHECK_EQ(convert("A", toSnake), "a");
+  CHECK_EQ(convert("HTTPServer", toSnake), "h_t_t_p_server");
+  CHECK_EQ(convert("lower", toSnake), "lower");
+  CHECK_EQ(camelToSnakeSize("FeelTheForce"), 14);
+  CHECK_EQ(convert(convert("FeelTheForce", toSnake), snake), "FeelTheForce");
+}
+
+TEST_CASE("case conversion into caller buffers") {
+  SUBCASE("string capacity is reused") {
+    std::string out;
+    snakeToCamel("a_very_long_identifier_name", out);
+    const auto *const data = out.data();
+    snakeToCamel("feel_the_force", out);
+    CHECK_EQ(out, "FeelTheForce");
+    CHECK_EQ(out.data(), data);
+  }
+  SUBCASE("span") {
+    std::array<char, 16> buf{};
+    const auto n = camelToKebab("FeelTheForce", buf);
+    CHECK_EQ(std::string_view(buf.data(), n), "feel-the-force");
+    std::array<char, 4> small{};
+    CHECK_THROWS_AS(snakeToCamel("feel_the_force", small), std::length_error);
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// A set of bytes as a 256 bit map, so membership is a shift and a mask
+// instead of a locale aware libc call. Usable at compile time.
+class CharSet {
+public:
+  constexpr CharSet() = default;
+  constexpr explicit CharSet(std::string_view chars) noexcept {
+    for (const char c : chars) {
+      insert(c);
+    }
+  }
+
+  // Every byte for which pred is true
+  template <typename Pred>
+  [[nodiscard]] static constexpr CharSet fromPredicate(Pred pred) noexcept {
+    CharSet set;
+    for (int c = 0; c < 256; ++c) {
+      if (pred(static_cast<unsigned char>(c))) {
+        set.insert(static_cast<char>(c));
+      }
+    }
+    return set;
+  }
+
+  constexpr void insert(char c) noexcept {
+    const auto u = static_cast<unsigned char>(c);
+    bits_[u / 64U] |= std::uint64_t{1} << (u % 64U);
+  }
+  [[nodiscard]] constexpr bool contains(char c) const noexcept {
+    const auto u = static_cast<unsigned char>(c);
+    return ((bits_[u / 64U] >> (u % 64U)) & 1U) != 0;
+  }
+
+  [[nodiscard]] constexpr CharSet operator~() const noexcept {
+    CharSet set;
+    for (std::size_t i = 0; i < bits_.size(); ++i) {
+      set.bits_[i] = ~bits_[i];
+    }
+    return set;
+  }
+  [[nodiscard]] friend constexpr CharSet operator|(CharSet a,
+                                                   const CharSet &b) noexcept {
+    for (std::size_t i = 0; i < a.bits_.size(); ++i) {
+      a.bits_[i] |= b.bits_[i];
+    }
+    return a;
+  }
+  friend constexpr bool operator==(const CharSet &,
+                                   const CharSet &) noexcept = default;
+
+  // Position of the first char of s at or after pos that is (not) in the
+  // set, std::string_view::npos if there is none
+  [[nodiscard]] constexpr std::size_t findIn(std::string_view s,
+                                             std::size_t pos = 0) const noexcept {
+    for (; pos < s.size(); ++pos) {
+      if (contains(s[pos])) {
+        return pos;
+      }
+    }
+    return std::string_view::npos;
+  }
+  [[nodiscard]] constexpr std::size_t
+  findNotIn(std::string_view s, std::size_t pos = 0) const noexcept {
+    for (; pos < s.size(); ++pos) {
+      if (!contains(s[pos])) {
+        return pos;
+      }
+    }
+    return std::string_view::npos;
+  }
+
+private:
+  std::array<std::uint64_t, 4> bits_{};
+};
+
+// What std::isspace accepts in the "C" locale
+inline constexpr CharSet asciiSpace(" \t\n\v\f\r");
+
+// What \w matches in the "C" locale, [A-Za-z0-9_]
+inline constexpr CharSet asciiWord = CharSet::fromPredicate([](unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+});
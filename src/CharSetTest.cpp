@@ -0,0 +1,38 @@
+#include "CharSet.hpp"
+
+#include <doctest/doctest.h>
+
+#include <cctype>
+
+static_assert(asciiSpace.contains(' ') && !asciiSpace.contains('a'));
+static_assert(CharSet("ab").findIn("xxbxa") == 2);
+
+TEST_CASE("CharSet") {
+  SUBCASE("asciiSpace matches isspace in the C locale") {
+    for (int c = 0; c < 256; ++c) {
+      CHECK_EQ(asciiSpace.contains(static_cast<char>(c)),
+               std::isspace(c) != 0);
+    }
+  }
+  SUBCASE("bytes above 127") {
+    const CharSet set("\xff\x80");
+    CHECK_UNARY(set.contains('\xff'));
+    CHECK_UNARY(set.contains('\x80'));
+    CHECK_UNARY_FALSE(set.contains('\x7f'));
+  }
+  SUBCASE("set operations") {
+    const CharSet digits = CharSet::fromPredicate(
+        [](unsigned char c) { return c >= '0' && c <= '9'; });
+    CHECK_EQ(digits, CharSet("0123456789"));
+    CHECK_UNARY((digits | CharSet("x")).contains('x'));
+    CHECK_UNARY((~digits).contains('a'));
+    CHECK_UNARY_FALSE((~digits).contains('5'));
+  }
+  SUBCASE("find") {
+    const CharSet ab("ab");
+    CHECK_EQ(ab.findIn("xyz"), std::string_view::npos);
+    CHECK_EQ(ab.findIn("xbz", 2), std::string_view::npos);
+    CHECK_EQ(ab.findNotIn("abba!"), 4);
+    CHECK_EQ(ab.findNotIn(""), std::string_view::npos);
+  }
+}
@@ -0,0 +1,149 @@
+#include "Cipher.hpp"
+
+#include "Simd.hpp"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TRY_RANGES_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+void applyTable(const SubstitutionCipher::Table &table, const char *in,
+                char *out, std::size_t n) noexcept {
+  std::size_t i = 0;
+  // Unrolled so the independent loads overlap
+  for (; i + 8 <= n; i += 8) {
+    const char c0 = table[static_cast<unsigned char>(in[i])];
+    const char c1 = table[static_cast<unsigned char>(in[i + 1])];
+    const char c2 = table[static_cast<unsigned char>(in[i + 2])];
+    const char c3 = table[static_cast<unsigned char>(in[i + 3])];
+    const char c4 = table[static_cast<unsigned char>(in[i + 4])];
+    const char c5 = table[static_cast<unsigned char>(in[i + 5])];
+    const char c6 = table[static_cast<unsigned char>(in[i + 6])];
+    const char c7 = table[static_cast<unsigned char>(in[i + 7])];
+    out[i] = c0;
+    out[i + 1] = c1;
+    out[i + 2] = c2;
+    out[i + 3] = c3;
+    out[i + 4] = c4;
+    out[i + 5] = c5;
+    out[i + 6] = c6;
+    out[i + 7] = c7;
+  }
+  for (; i < n; ++i) {
+    out[i] = table[static_cast<unsigned char>(in[i])];
+  }
+}
+
+#ifdef TRY_RANGES_SIMD_X86
+// Rotates the letters of [first, first + 26) in v by shift (0..25). v - first
+// wraps around, so only those 26 bytes land in [0, 26).
+__attribute__((target("sse2"))) __m128i rotateSse2(__m128i v, char first,
+                                                   char shift) noexcept {
+  const __m128i x = _mm_sub_epi8(v, _mm_set1_epi8(first));
+  const __m128i in = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(-1)),
+                                   _mm_cmplt_epi8(x, _mm_set1_epi8(26)));
+  __m128i y = _mm_add_epi8(x, _mm_set1_epi8(shift));
+  y = _mm_sub_epi8(y, _mm_and_si128(_mm_cmpgt_epi8(y, _mm_set1_epi8(25)),
+                                    _mm_set1_epi8(26)));
+  y = _mm_add_epi8(y, _mm_set1_epi8(first));
+  return _mm_or_si128(_mm_and_si128(in, y), _mm_andnot_si128(in, v));
+}
+
+__attribute__((target("sse2"))) std::size_t
+caesarSse2(const char *in, char *out, std::size_t n, char shift) noexcept {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    v = rotateSse2(rotateSse2(v, 'a', shift), 'A', shift);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), v);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) __m256i rotateAvx2(__m256i v, char first,
+                                                   char shift) noexcept {
+  const __m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(first));
+  const __m256i in =
+      _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(-1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8(26), x));
+  __m256i y = _mm256_add_epi8(x, _mm256_set1_epi8(shift));
+  y = _mm256_sub_epi8(
+      y, _mm256_and_si256(_mm256_cmpgt_epi8(y, _mm256_set1_epi8(25)),
+                          _mm256_set1_epi8(26)));
+  y = _mm256_add_epi8(y, _mm256_set1_epi8(first));
+  return _mm256_blendv_epi8(v, y, in);
+}
+
+__attribute__((target("avx2"))) std::size_t
+caesarAvx2(const char *in, char *out, std::size_t n, char shift) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    v = rotateAvx2(rotateAvx2(v, 'a', shift), 'A', shift);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+  }
+  return i;
+}
+#endif
+
+// How many leading bytes a vector kernel handled
+std::size_t applyCaesar([[maybe_unused]] const char *in,
+                        [[maybe_unused]] char *out,
+                        [[maybe_unused]] std::size_t n,
+                        [[maybe_unused]] int shift) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  switch (simd::activeIsa()) {
+  case simd::Isa::Avx2:
+    return caesarAvx2(in, out, n, static_cast<char>(shift));
+  case simd::Isa::Sse2:
+    return caesarSse2(in, out, n, static_cast<char>(shift));
+  case simd::Isa::Scalar:
+  case simd::Isa::Neon:
+    break;
+  }
+#endif
+  return 0;
+}
+} // namespace
+
+SubstitutionCipher SubstitutionCipher::inverse() const {
+  if (shift_ >= 0) {
+    return caesar(26 - shift_);
+  }
+  Table inv{};
+  std::array<bool, 256> seen{};
+  for (std::size_t i = 0; i < table_.size(); ++i) {
+    const auto c = static_cast<unsigned char>(table_[i]);
+    if (seen[c]) {
+      throw std::invalid_argument("SubstitutionCipher: table is not a "
+                                  "bijection");
+    }
+    seen[c] = true;
+    inv[c] = static_cast<char>(i);
+  }
+  return SubstitutionCipher(inv);
+}
+
+void SubstitutionCipher::apply(std::span<char> s) const noexcept {
+  const std::size_t done =
+      shift_ >= 0 ? applyCaesar(s.data(), s.data(), s.size(), shift_) : 0;
+  applyTable(table_, s.data() + done, s.data() + done, s.size() - done);
+}
+
+void SubstitutionCipher::apply(std::string_view in, std::span<char> out) const {
+  if (out.size() < in.size()) {
+    throw std::length_error("SubstitutionCipher: output shorter than input");
+  }
+  const std::size_t done =
+      shift_ >= 0 ? applyCaesar(in.data(), out.data(), in.size(), shift_) : 0;
+  applyTable(table_, in.data() + done, out.data() + done, in.size() - done);
+}
+
+std::string SubstitutionCipher::encode(std::string_view in) const {
+  std::string out(in.size(), '\0');
+  apply(in, out);
+  return out;
+}
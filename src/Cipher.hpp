@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Byte to byte substitution through a 256 entry table. Also a char -> char
+// function object, so it works as s | rv::transform(std::cref(cipher)).
+class SubstitutionCipher {
+public:
+  using Table = std::array<char, 256>;
+
+  // The identity
+  constexpr SubstitutionCipher() noexcept {
+    for (std::size_t i = 0; i < table_.size(); ++i) {
+      table_[i] = static_cast<char>(i);
+    }
+  }
+  constexpr explicit SubstitutionCipher(const Table &table) noexcept
+      : table_(table) {}
+
+  // Rotates a-z and A-Z by shift, leaves every other byte alone. Is constexpr,
+  // so a fixed shift builds its table at compile time
+  [[nodiscard]] static constexpr SubstitutionCipher caesar(int shift) noexcept {
+    shift = ((shift % 26) + 26) % 26;
+    SubstitutionCipher cipher;
+    for (int i = 0; i < 26; ++i) {
+      cipher.table_[static_cast<std::size_t>('a' + i)] =
+          static_cast<char>('a' + (i + shift) % 26);
+      cipher.table_[static_cast<std::size_t>('A' + i)] =
+          static_cast<char>('A' + (i + shift) % 26);
+    }
+    cipher.shift_ = shift;
+    return cipher;
+  }
+
+  [[nodiscard]] constexpr char operator()(char c) const noexcept {
+    return table_[static_cast<unsigned char>(c)];
+  }
+  [[nodiscard]] constexpr const Table &table() const noexcept { return table_; }
+
+  // The cipher undoing this one, throws std::invalid_argument if the table
+  // maps two bytes to the same one
+  [[nodiscard]] SubstitutionCipher inverse() const;
+
+  void apply(std::span<char> s) const noexcept;
+  // out must be at least as long as in, std::length_error is thrown otherwise
+  void apply(std::string_view in, std::span<char> out) const;
+  [[nodiscard]] std::string encode(std::string_view in) const;
+
+private:
+  Table table_{};
+  // Caesar ciphers are computed with vector arithmetic instead of lookups
+  int shift_ = -1;
+};
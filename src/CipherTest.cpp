@@ -0,0 +1,74 @@
+#include "Cipher.hpp"
+#include "Simd.hpp"
+#include "SimdTestSupport.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <array>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+static_assert(SubstitutionCipher::caesar(11)('a') == 'l');
+static_assert(SubstitutionCipher::caesar(-1)('a') == 'z');
+
+TEST_CASE("SubstitutionCipher") {
+  SUBCASE("Caesar cipher of the range test") {
+    constexpr auto cipher = SubstitutionCipher::caesar(11);
+    CHECK_EQ(cipher.encode("apple"), "laawp");
+    CHECK_EQ(cipher.encode("Apple, 42!"), "Laawp, 42!");
+    CHECK_EQ(cipher.inverse().encode("laawp"), "apple");
+  }
+  SUBCASE("every kernel agrees with the table") {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string s(1000, '\0');
+    for (auto &c : s) {
+      c = static_cast<char>(byte(gen));
+    }
+    for (const int shift : {0, 1, 13, 25, 26, -3}) {
+      const auto cipher = SubstitutionCipher::caesar(shift);
+      std::string expected = s;
+      for (auto &c : expected) {
+        c = cipher.table()[static_cast<unsigned char>(c)];
+      }
+      forEachIsa([&](simd::Isa) {
+        CHECK_EQ(cipher.encode(s), expected);
+        std::string inplace = s;
+        cipher.apply(inplace);
+        CHECK_EQ(inplace, expected);
+      });
+    }
+  }
+  SUBCASE("any table") {
+    SubstitutionCipher::Table table{};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+      table[i] = static_cast<char>(255 - i);
+    }
+    const SubstitutionCipher cipher(table);
+    const std::string s = "hello, world";
+    CHECK_EQ(cipher.inverse().encode(cipher.encode(s)), s);
+    table[1] = table[0];
+    CHECK_THROWS_AS((void)SubstitutionCipher(table).inverse(),
+                    std::invalid_argument);
+  }
+  SUBCASE("caller provided output") {
+    const auto cipher = SubstitutionCipher::caesar(1);
+    std::array<char, 4> out{};
+    cipher.apply("abc", out);
+    CHECK_EQ(std::string(out.data(), 3), "bcd");
+    std::array<char, 2> small{};
+    CHECK_THROWS_AS(cipher.apply("abc", small), std::length_error);
+  }
+  SUBCASE("as a transform") {
+    const auto cipher = SubstitutionCipher::caesar(11);
+    const auto s = std::string_view("apple") |
+                   ranges::views::transform(std::cref(cipher)) |
+                   ranges::to<std::string>();
+    CHECK_EQ(s, "laawp");
+  }
+}
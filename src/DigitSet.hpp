@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+
+namespace detail {
+// Bit d of [n] is set iff n, 0 to 9999, has the digit d. Padded counts the
+// leading zeros of four digits too, for the low parts of longer numbers.
+template <bool Padded> constexpr std::array<std::uint16_t, 10000> digitMasks() {
+  std::array<std::uint16_t, 10000> masks{};
+  for (unsigned n = 0; n < masks.size(); ++n) {
+    unsigned m = 0;
+    unsigned x = n;
+    for (int i = 0; i < 4 && (Padded || i == 0 || x != 0); ++i, x /= 10) {
+      m |= 1U << (x % 10);
+    }
+    masks[n] = static_cast<std::uint16_t>(m);
+  }
+  return masks;
+}
+
+inline constexpr auto digitMaskTable = digitMasks<false>();
+inline constexpr auto paddedDigitMaskTable = digitMasks<true>();
+
+template <std::integral T>
+[[nodiscard]] constexpr std::uint64_t magnitude(T n) noexcept {
+  const auto u = static_cast<std::uint64_t>(n);
+  if constexpr (std::signed_integral<T>) {
+    return n < 0 ? 0 - u : u;
+  } else {
+    return u;
+  }
+}
+} // namespace detail
+
+// A set of decimal digits as a 10 bit mask, e.g. the digits a number is
+// written with, found four at a time in a table instead of through
+// std::to_string, so a pandigital test neither allocates nor sorts. Usable
+// at compile time.
+class DigitSet {
+public:
+  constexpr DigitSet() = default;
+  // The digits in s, other chars are ignored
+  constexpr explicit DigitSet(std::string_view s) noexcept {
+    for (const char c : s) {
+      if (c >= '0' && c <= '9') {
+        insert(static_cast<unsigned>(c - '0'));
+      }
+    }
+  }
+
+  // The digits n is written with in decimal, 0 for 0, the sign ignored
+  template <std::integral T>
+  [[nodiscard]] static constexpr DigitSet of(T n) noexcept {
+    std::uint64_t u = detail::magnitude(n);
+    unsigned m = 0;
+    for (; u >= 10000; u /= 10000) {
+      m |= detail::paddedDigitMaskTable[u % 10000];
+    }
+    DigitSet set;
+    set.bits_ = static_cast<std::uint16_t>(m | detail::digitMaskTable[u]);
+    return set;
+  }
+
+  constexpr void insert(unsigned digit) noexcept {
+    bits_ = static_cast<std::uint16_t>(bits_ | 1U << digit);
+  }
+  [[nodiscard]] constexpr bool contains(unsigned digit) const noexcept {
+    return digit < 10 && (bits_ >> digit & 1U) != 0;
+  }
+  [[nodiscard]] constexpr unsigned size() const noexcept {
+    return static_cast<unsigned>(std::popcount(bits_));
+  }
+  [[nodiscard]] constexpr bool empty() const noexcept { return bits_ == 0; }
+  // Bit d is set iff d is in the set
+  [[nodiscard]] constexpr std::uint16_t mask() const noexcept { return bits_; }
+
+  [[nodiscard]] friend constexpr DigitSet operator|(DigitSet a,
+                                                    DigitSet b) noexcept {
+    a.bits_ = static_cast<std::uint16_t>(a.bits_ | b.bits_);
+    return a;
+  }
+  [[nodiscard]] friend constexpr DigitSet operator&(DigitSet a,
+                                                    DigitSet b) noexcept {
+    a.bits_ = static_cast<std::uint16_t>(a.bits_ & b.bits_);
+    return a;
+  }
+  friend constexpr bool operator==(DigitSet, DigitSet) noexcept = default;
+
+private:
+  std::uint16_t bits_ = 0;
+};
+
+inline constexpr DigitSet allDigits("0123456789");
+// 1 to 9, the digits of a zeroless pandigital number
+inline constexpr DigitSet nonZeroDigits("123456789");
+
+// How many decimal digits n is written with, 1 for 0, the sign ignored
+template <std::integral T>
+[[nodiscard]] constexpr unsigned digitCount(T n) noexcept {
+  std::uint64_t u = detail::magnitude(n);
+  unsigned count = 1;
+  for (; u >= 10; u /= 10) {
+    ++count;
+  }
+  return count;
+}
+
+// No digit of n comes twice, e.g. 9876543210 but not 1231
+template <std::integral T>
+[[nodiscard]] constexpr bool distinctDigits(T n) noexcept {
+  return DigitSet::of(n).size() == digitCount(n);
+}
@@ -0,0 +1,51 @@
+#include "DigitSet.hpp"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+static_assert(DigitSet::of(1234567890) == allDigits);
+static_assert(DigitSet::of(10005) == DigitSet("015"));
+static_assert(distinctDigits(9876543210) && !distinctDigits(1231));
+
+namespace {
+DigitSet viaString(std::uint64_t n) { return DigitSet(std::to_string(n)); }
+} // namespace
+
+TEST_CASE("DigitSet") {
+  SUBCASE("same as the digits of std::to_string") {
+    for (std::uint64_t n = 0; n < 200000; ++n) {
+      CHECK_EQ(DigitSet::of(n), viaString(n));
+    }
+    std::mt19937_64 gen(21);
+    for (int i = 0; i < 10000; ++i) {
+      const std::uint64_t n = gen() >> (gen() % 64);
+      CHECK_EQ(DigitSet::of(n), viaString(n));
+      CHECK_EQ(digitCount(n), std::to_string(n).size());
+    }
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+    CHECK_EQ(DigitSet::of(max), viaString(max));
+  }
+  SUBCASE("zero and negative numbers") {
+    CHECK_EQ(DigitSet::of(0), DigitSet("0"));
+    CHECK_EQ(digitCount(0), 1);
+    CHECK_EQ(DigitSet::of(-907), DigitSet("079"));
+    CHECK_EQ(digitCount(-907), 3);
+    constexpr auto min = std::numeric_limits<std::int64_t>::min();
+    CHECK_EQ(DigitSet::of(min), DigitSet("9223372036854775808"));
+  }
+  SUBCASE("set operations") {
+    const DigitSet a("135");
+    CHECK_EQ(a.size(), 3);
+    CHECK_UNARY(a.contains(3));
+    CHECK_UNARY_FALSE(a.contains(2));
+    CHECK_UNARY_FALSE(a.contains(10));
+    CHECK_EQ(a | DigitSet("2"), DigitSet("1235"));
+    CHECK_EQ(a & DigitSet("3456"), DigitSet("35"));
+    CHECK_UNARY(DigitSet().empty());
+    CHECK_EQ(nonZeroDigits.mask(), 0x3FE);
+  }
+}
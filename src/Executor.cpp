@@ -0,0 +1,115 @@
+#include "Executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace {
+struct ParallelForState {
+  const std::function<void(std::size_t)> *f;
+  std::size_t n;
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> done{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  ParallelForState(const std::function<void(std::size_t)> &fn, std::size_t count)
+      : f(&fn), n(count) {}
+
+  // f is only touched for claimed indices, so helpers that start after the
+  // loop finished never see a dangling f
+  void run() {
+    for (std::size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+      try {
+        (*f)(i);
+      } catch (...) {
+        const std::lock_guard lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      if (done.fetch_add(1) + 1 == n) {
+        done.notify_all();
+      }
+    }
+  }
+};
+} // namespace
+
+// Shared with the tasks, which may still be notifying when sync has
+// returned and the group is gone
+struct TaskGroup::State {
+  std::atomic<std::size_t> pending{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
+
+void parallelFor(Executor &ex, std::size_t n,
+                 const std::function<void(std::size_t)> &f) {
+  if (n == 0) {
+    return;
+  }
+  auto state = std::make_shared<ParallelForState>(f, n);
+  // An executor may report no concurrency, the caller still runs
+  const std::size_t helpers =
+      std::min(n, std::max<std::size_t>(ex.concurrency(), 1)) - 1;
+  for (std::size_t i = 0; i < helpers; ++i) {
+    ex.post([state] { state->run(); });
+  }
+  state->run();
+  for (auto d = state->done.load(); d != n; d = state->done.load()) {
+    if (!ex.tryRunOne()) {
+      state->done.wait(d);
+    }
+  }
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+TaskGroup::TaskGroup(Executor &ex)
+    : ex_(ex), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+  try {
+    sync();
+  } catch (...) {
+    // Only sync reports errors
+  }
+}
+
+void TaskGroup::spawn(std::function<void()> f) {
+  state_->pending.fetch_add(1);
+  ex_.post([state = state_, f = std::move(f)] {
+    try {
+      f();
+    } catch (...) {
+      const std::lock_guard lock(state->errorMutex);
+      if (!state->error) {
+        state->error = std::current_exception();
+      }
+    }
+    if (state->pending.fetch_sub(1) == 1) {
+      state->pending.notify_all();
+    }
+  });
+}
+
+void TaskGroup::sync() {
+  for (auto p = state_->pending.load(); p != 0; p = state_->pending.load()) {
+    if (!ex_.tryRunOne()) {
+      state_->pending.wait(p);
+    }
+  }
+  std::exception_ptr error;
+  {
+    const std::lock_guard lock(state_->errorMutex);
+    error = std::exchange(state_->error, nullptr);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
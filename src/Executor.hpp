@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+// Where the parallel utilities run their work
+class Executor {
+public:
+  Executor() = default;
+  Executor(const Executor &) = delete;
+  Executor &operator=(const Executor &) = delete;
+  Executor(Executor &&) = delete;
+  Executor &operator=(Executor &&) = delete;
+  virtual ~Executor() = default;
+
+  // Runs task at some point, possibly on another thread
+  virtual void post(std::function<void()> task) = 0;
+  // How many tasks can usefully run at the same time
+  [[nodiscard]] virtual std::size_t concurrency() const noexcept = 0;
+  // Runs one queued task on the calling thread, if there is one. Waits call
+  // it to help out instead of blocking a thread the executor could use.
+  virtual bool tryRunOne() { return false; }
+};
+
+// Runs every task right away on the posting thread
+class InlineExecutor final : public Executor {
+public:
+  void post(std::function<void()> task) override { task(); }
+  [[nodiscard]] std::size_t concurrency() const noexcept override { return 1; }
+};
+
+// Calls f(i) for every i in [0, n) and returns once all calls are done. The
+// calling thread takes part, so this never waits on a busy executor. The
+// first exception thrown by f is rethrown after the remaining calls finish.
+void parallelFor(Executor &ex, std::size_t n,
+                 const std::function<void(std::size_t)> &f);
+
+// Fork/join on an executor: spawn runs f concurrently with the caller, sync
+// returns once every spawned f is done and rethrows the first exception one
+// of them threw. A waiting sync runs queued tasks, so groups nest inside
+// pool tasks to any depth without tying up the workers.
+class TaskGroup {
+public:
+  explicit TaskGroup(Executor &ex);
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+  TaskGroup(TaskGroup &&) = delete;
+  TaskGroup &operator=(TaskGroup &&) = delete;
+  // Waits like sync, an exception is dropped
+  ~TaskGroup();
+
+  void spawn(std::function<void()> f);
+  void sync();
+
+private:
+  struct State;
+
+  Executor &ex_;
+  std::shared_ptr<State> state_;
+};
@@ -0,0 +1,188 @@
+#include "Executor.hpp"
+#include "ThreadPool.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("parallelFor") {
+  ThreadPool pool(4);
+  InlineExecutor inline_executor;
+  SUBCASE("calls f once per index") {
+    for (Executor *ex : {static_cast<Executor *>(&pool),
+                         static_cast<Executor *>(&inline_executor)}) {
+      std::vector<std::atomic<int>> calls(1000);
+      parallelFor(*ex, calls.size(), [&](std::size_t i) { ++calls[i]; });
+      for (const auto &c : calls) {
+        CHECK_EQ(c.load(), 1);
+      }
+    }
+  }
+  SUBCASE("an executor without concurrency posts nothing") {
+    struct Idle final : Executor {
+      void post(std::function<void()>) override { CHECK_UNARY(false); }
+      [[nodiscard]] std::size_t concurrency() const noexcept override {
+        return 0;
+      }
+    } idle;
+    int calls = 0;
+    parallelFor(idle, 10, [&](std::size_t) { ++calls; });
+    CHECK_EQ(calls, 10);
+  }
+  SUBCASE("empty range") {
+    parallelFor(pool, 0, [](std::size_t) { CHECK_UNARY(false); });
+  }
+  SUBCASE("rethrows after all calls are done") {
+    std::atomic<int> calls{0};
+    CHECK_THROWS_AS(parallelFor(pool, 100,
+                                [&](std::size_t i) {
+                                  ++calls;
+                                  if (i == 10) {
+                                    throw std::runtime_error("boom");
+                                  }
+                                }),
+                    std::runtime_error);
+    CHECK_EQ(calls.load(), 100);
+  }
+  SUBCASE("nested calls do not deadlock") {
+    std::atomic<int> calls{0};
+    parallelFor(pool, 8, [&](std::size_t) {
+      parallelFor(pool, 8, [&](std::size_t) { ++calls; });
+    });
+    CHECK_EQ(calls.load(), 64);
+  }
+}
+
+TEST_CASE("ThreadPool") {
+  std::atomic<int> calls{0};
+  {
+    ThreadPool pool(2);
+    CHECK_EQ(pool.concurrency(), 2);
+    for (int i = 0; i < 100; ++i) {
+      pool.post([&] { ++calls; });
+    }
+  }
+  CHECK_EQ(calls.load(), 100);
+  SUBCASE("tasks posted by tasks run before the workers join") {
+    std::atomic<int> nested{0};
+    {
+      ThreadPool pool(3);
+      for (int i = 0; i < 10; ++i) {
+        pool.post([&] {
+          for (int j = 0; j < 10; ++j) {
+            pool.post([&] { ++nested; });
+          }
+        });
+      }
+    }
+    CHECK_EQ(nested.load(), 100);
+  }
+  SUBCASE("pinned workers") {
+    for (const auto pinning : {Pinning::Cpus, Pinning::NumaNodes}) {
+      ThreadPool pool(2, pinning);
+      std::atomic<int> n{0};
+      parallelFor(pool, 100, [&](std::size_t) { ++n; });
+      CHECK_EQ(n.load(), 100);
+    }
+  }
+  SUBCASE("shared pool") {
+    CHECK_EQ(&ThreadPool::shared(), &ThreadPool::shared());
+    CHECK_GE(ThreadPool::shared().concurrency(), 1);
+  }
+}
+
+TEST_CASE("WorkStealingDeque") {
+  SUBCASE("owner pops newest, thieves steal oldest") {
+    WorkStealingDeque<int> d(2);
+    CHECK_UNARY(d.empty());
+    for (int i = 0; i < 10; ++i) {
+      d.push(i);
+    }
+    CHECK_EQ(d.steal(), 0);
+    CHECK_EQ(d.pop(), 9);
+    CHECK_EQ(d.steal(), 1);
+    for (int i = 8; i >= 2; --i) {
+      CHECK_EQ(d.pop(), i);
+    }
+    CHECK_UNARY(!d.pop());
+    CHECK_UNARY(!d.steal());
+  }
+  SUBCASE("every element is taken exactly once") {
+    constexpr int n = 100000;
+    WorkStealingDeque<int> d(16);
+    std::vector<std::atomic<int>> taken(n);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+      thieves.emplace_back([&] {
+        while (!done.load() || !d.empty()) {
+          if (const auto x = d.steal()) {
+            ++taken[static_cast<std::size_t>(*x)];
+          }
+        }
+      });
+    }
+    for (int i = 0; i < n; ++i) {
+      d.push(i);
+      if (i % 3 == 0) {
+        if (const auto x = d.pop()) {
+          ++taken[static_cast<std::size_t>(*x)];
+        }
+      }
+    }
+    while (const auto x = d.pop()) {
+      ++taken[static_cast<std::size_t>(*x)];
+    }
+    done.store(true);
+    for (auto &t : thieves) {
+      t.join();
+    }
+    CHECK_UNARY(std::all_of(taken.begin(), taken.end(),
+                            [](const auto &c) { return c.load() == 1; }));
+  }
+}
+
+TEST_CASE("TaskGroup") {
+  ThreadPool pool(4);
+  InlineExecutor inline_executor;
+  SUBCASE("recursive spawn and sync") {
+    const std::function<std::uint64_t(unsigned)> fib = [&](unsigned n) {
+      if (n < 2) {
+        return std::uint64_t{n};
+      }
+      std::uint64_t a = 0;
+      TaskGroup g(pool);
+      g.spawn([&] { a = fib(n - 1); });
+      const std::uint64_t b = fib(n - 2);
+      g.sync();
+      return a + b;
+    };
+    CHECK_EQ(fib(20), 6765);
+  }
+  SUBCASE("waits for every task") {
+    for (Executor *ex : {static_cast<Executor *>(&pool),
+                         static_cast<Executor *>(&inline_executor)}) {
+      std::atomic<int> calls{0};
+      TaskGroup g(*ex);
+      for (int i = 0; i < 100; ++i) {
+        g.spawn([&] { ++calls; });
+      }
+      g.sync();
+      CHECK_EQ(calls.load(), 100);
+    }
+  }
+  SUBCASE("rethrows from sync") {
+    TaskGroup g(pool);
+    g.spawn([] { throw std::runtime_error("boom"); });
+    g.spawn([] {});
+    CHECK_THROWS_AS(g.sync(), std::runtime_error);
+    g.sync();
+  }
+}
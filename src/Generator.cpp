@@ -0,0 +1,84 @@
+#include "Generator.hpp"
+
+#include <array>
+#include <new>
+
+namespace {
+struct FreeFrame {
+  FreeFrame *next;
+};
+
+constexpr std::size_t sizeClasses = detail::frameMaxSize / detail::frameAlign;
+
+// Set once the thread's pool is destroyed. Frames made or freed after that,
+// by a generator with static storage or one a thread_local destructor
+// releases, go straight to operator new and delete. Trivially destructible,
+// so it is still there for them.
+thread_local bool poolDestroyed = false;
+
+class FramePool {
+public:
+  FramePool() = default;
+  FramePool(const FramePool &) = delete;
+  FramePool &operator=(const FramePool &) = delete;
+  ~FramePool() {
+    poolDestroyed = true;
+    for (FreeFrame *head : heads_) {
+      while (head != nullptr) {
+        ::operator delete(std::exchange(head, head->next));
+      }
+    }
+  }
+
+  void *allocate(std::size_t c) {
+    if (FreeFrame *f = heads_[c]) {
+      heads_[c] = f->next;
+      --counts_[c];
+      return f;
+    }
+    return ::operator new((c + 1) * detail::frameAlign);
+  }
+
+  void deallocate(void *p, std::size_t c) noexcept {
+    if (counts_[c] == detail::frameCacheDepth) {
+      ::operator delete(p);
+      return;
+    }
+    heads_[c] = ::new (p) FreeFrame{heads_[c]};
+    ++counts_[c];
+  }
+
+private:
+  std::array<FreeFrame *, sizeClasses> heads_{};
+  std::array<std::size_t, sizeClasses> counts_{};
+};
+
+thread_local FramePool pool;
+
+// Frames of 1 to frameAlign bytes are class 0, and so on
+std::size_t sizeClass(std::size_t size) noexcept {
+  return (size - 1) / detail::frameAlign;
+}
+} // namespace
+
+namespace detail {
+void *allocateFrame(std::size_t size) {
+  if (size == 0 || size > frameMaxSize) {
+    return ::operator new(size);
+  }
+  const std::size_t c = sizeClass(size);
+  if (poolDestroyed) {
+    // The whole class, the frame may be freed into another thread's pool
+    return ::operator new((c + 1) * frameAlign);
+  }
+  return pool.allocate(c);
+}
+
+void deallocateFrame(void *p, std::size_t size) noexcept {
+  if (size == 0 || size > frameMaxSize || poolDestroyed) {
+    ::operator delete(p);
+    return;
+  }
+  pool.deallocate(p, sizeClass(size));
+}
+} // namespace detail
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+// Coroutine frames up to frameMaxSize bytes, rounded up to frameAlign, are
+// kept for reuse in free lists per size and per thread, at most
+// frameCacheDepth of each size. So a generator made again and again, as in
+// a loop, only allocates the first time. A frame freed on another thread
+// joins that thread's lists, larger frames come from operator new.
+inline constexpr std::size_t frameAlign = 64;
+inline constexpr std::size_t frameMaxSize = 2048;
+inline constexpr std::size_t frameCacheDepth = 64;
+
+[[nodiscard]] void *allocateFrame(std::size_t size);
+void deallocateFrame(void *p, std::size_t size) noexcept;
+} // namespace detail
+
+// An input range of what a coroutine co_yields, so that a nested search can
+// be a few plain loops instead of a stack of views::for_each, whose every
+// ++ goes through all the levels, and still be piped into the range-v3
+// views. Each element is a const T & to the operand of the co_yield, valid
+// until the next ++. The coroutine starts at begin(), an exception it
+// throws comes out of begin() or ++. Like a container it is no view, it is
+// move only and owns the frame, so views take a named one by reference.
+template <typename T>
+  requires std::is_object_v<T> && std::same_as<T, std::remove_cv_t<T>>
+class generator {
+public:
+  class promise_type;
+
+private:
+  using handle = std::coroutine_handle<promise_type>;
+
+public:
+  class promise_type {
+  public:
+    generator get_return_object() noexcept {
+      return generator(handle::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+    // x, or the temporary it converts to, lives until the coroutine resumes
+    std::suspend_always yield_value(const T &x) noexcept {
+      value_ = std::addressof(x);
+      return {};
+    }
+    void return_void() const noexcept {}
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+    // Nothing would resume it
+    template <typename U> void await_transform(U &&) = delete;
+
+    static void *operator new(std::size_t size) {
+      return detail::allocateFrame(size);
+    }
+    static void operator delete(void *p, std::size_t size) noexcept {
+      detail::deallocateFrame(p, size);
+    }
+
+  private:
+    friend generator;
+    const T *value_ = nullptr;
+    std::exception_ptr error_;
+  };
+
+  class iterator {
+  public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    const T &operator*() const { return *coro_.promise().value_; }
+    iterator &operator++() {
+      resume(coro_);
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return it.coro_.done();
+    }
+
+  private:
+    friend generator;
+    explicit iterator(handle coro) : coro_(coro) {}
+
+    handle coro_;
+  };
+
+  generator(generator &&other) noexcept
+      : coro_(std::exchange(other.coro_, {})) {}
+  generator &operator=(generator &&other) noexcept {
+    if (this != &other) {
+      destroy();
+      coro_ = std::exchange(other.coro_, {});
+    }
+    return *this;
+  }
+  generator(const generator &) = delete;
+  generator &operator=(const generator &) = delete;
+  ~generator() { destroy(); }
+
+  // Only once, an input range is consumed by its iteration
+  [[nodiscard]] iterator begin() {
+    resume(coro_);
+    return iterator(coro_);
+  }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  explicit generator(handle coro) noexcept : coro_(coro) {}
+
+  static void resume(handle coro) {
+    coro.resume();
+    if (auto &error = coro.promise().error_) {
+      std::rethrow_exception(std::exchange(error, {}));
+    }
+  }
+
+  void destroy() noexcept {
+    if (coro_) {
+      coro_.destroy();
+    }
+  }
+
+  handle coro_;
+};
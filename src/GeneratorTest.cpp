@@ -0,0 +1,176 @@
+#include "Generator.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/take.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+using Triple = std::tuple<int, int, int>;
+
+// "triangles 2" of TryRangesTest as plain loops
+generator<Triple> triangles(int maxC) {
+  for (int c = 1; c <= maxC; ++c) {
+    for (int b = 1; b <= c; ++b) {
+      for (int a = 1; a <= b && a * a + b * b <= c * c; ++a) {
+        if (a * a + b * b == c * c) {
+          co_yield {a, b, c};
+        }
+      }
+    }
+  }
+}
+
+generator<long> naturals() {
+  for (int i = 0;; ++i) {
+    co_yield i;
+  }
+}
+
+generator<int> throwsAfter(int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+  throw std::runtime_error("done");
+}
+
+generator<std::string> words(std::vector<std::string> v) {
+  for (const auto &w : v) {
+    co_yield w;
+  }
+}
+} // namespace
+
+TEST_CASE("generator") {
+  SUBCASE("a nested search") {
+    std::vector<Triple> found;
+    for (const auto &t : triangles(10)) {
+      found.push_back(t);
+    }
+    const std::vector<Triple> expected = {{3, 4, 5}, {6, 8, 10}};
+    CHECK_EQ(found, expected);
+  }
+
+  SUBCASE("piped into views") {
+    auto g = triangles(30);
+    const auto perimeters =
+        g | ranges::views::filter([](const Triple &t) {
+          return std::get<0>(t) % 2 == 1;
+        }) |
+        ranges::views::transform([](const Triple &t) {
+          return std::get<0>(t) + std::get<1>(t) + std::get<2>(t);
+        }) |
+        ranges::to<std::vector>();
+    const std::vector expected = {12, 30, 36, 60, 56};
+    CHECK_EQ(perimeters, expected);
+  }
+
+  SUBCASE("infinite, ended early") {
+    auto n = naturals();
+    const auto first = n | ranges::views::take(4) | ranges::to<std::vector>();
+    const std::vector<long> expected = {0, 1, 2, 3};
+    CHECK_EQ(first, expected);
+  }
+
+  SUBCASE("empty") {
+    auto g = triangles(4);
+    CHECK_UNARY(g.begin() == g.end());
+  }
+
+  SUBCASE("moved") {
+    auto g = words({"a", "bb", "ccc"});
+    auto h = std::move(g);
+    auto it = h.begin();
+    CHECK_EQ(*it, "a");
+    g = std::move(h);
+    ++it;
+    CHECK_EQ(*it, "bb");
+  }
+
+  SUBCASE("exceptions come out of begin and ++") {
+    auto none = throwsAfter(0);
+    CHECK_THROWS_AS((void)none.begin(), std::runtime_error);
+    auto two = throwsAfter(2);
+    auto it = two.begin();
+    ++it;
+    CHECK_EQ(*it, 1);
+    CHECK_THROWS_AS(++it, std::runtime_error);
+  }
+}
+
+TEST_CASE("coroutine frames are reused") {
+  void *p = detail::allocateFrame(100);
+  detail::deallocateFrame(p, 100);
+  // The same size class
+  void *q = detail::allocateFrame(128);
+  CHECK_EQ(q, p);
+  detail::deallocateFrame(q, 128);
+
+  void *large = detail::allocateFrame(detail::frameMaxSize + 1);
+  detail::deallocateFrame(large, detail::frameMaxSize + 1);
+
+  // More than are kept are freed
+  std::vector<void *> frames;
+  for (std::size_t i = 0; i < 2 * detail::frameCacheDepth; ++i) {
+    frames.push_back(detail::allocateFrame(64));
+  }
+  for (void *f : frames) {
+    detail::deallocateFrame(f, 64);
+  }
+}
+
+TEST_CASE("coroutine frames outlive the thread's pool") {
+  // Constructed before the thread's first frame, so destroyed after its
+  // pool: the destructor makes a generator, then the member frees one
+  struct Late {
+    std::optional<generator<long>> held;
+    Late() = default;
+    Late(const Late &) = delete;
+    Late &operator=(const Late &) = delete;
+    ~Late() {
+      auto g = naturals();
+      (void)g.begin();
+    }
+  };
+  std::thread([] {
+    thread_local Late late;
+    late.held.emplace(naturals());
+    CHECK_EQ(*late.held->begin(), 0);
+  }).join();
+}
+
+TEST_CASE("a frame made after the pool is reused at its full class") {
+  // Made by a thread_local destructor once that thread's pool is gone,
+  // then freed into the pool of another one
+  void *frame = nullptr;
+  struct Late {
+    void **out;
+    explicit Late(void **o) : out(o) {}
+    Late(const Late &) = delete;
+    Late &operator=(const Late &) = delete;
+    ~Late() { *out = detail::allocateFrame(1); }
+  };
+  std::thread([&frame] {
+    thread_local Late late(&frame);
+    detail::deallocateFrame(detail::allocateFrame(1), 1);
+  }).join();
+  REQUIRE_NE(frame, nullptr);
+  std::thread([frame] {
+    detail::deallocateFrame(frame, 1);
+    void *p = detail::allocateFrame(detail::frameAlign);
+    CHECK_EQ(p, frame);
+    std::memset(p, 0, detail::frameAlign);
+    detail::deallocateFrame(p, detail::frameAlign);
+  }).join();
+}
@@ -0,0 +1,165 @@
+#include "Instrument.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// name as a JSON string, or a Prometheus label value, which escapes the
+// same way but for the control chars other than '\n'
+std::string quoted(std::string_view name, bool json) {
+  std::string s = "\"";
+  for (const char c : name) {
+    if (c == '"' || c == '\\') {
+      s += '\\';
+      s += c;
+    } else if (c == '\n') {
+      s += "\\n";
+    } else if (json && static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+      s += buf;
+    } else {
+      s += c;
+    }
+  }
+  s += '"';
+  return s;
+}
+
+struct Field {
+  const char *name;
+  const char *help;
+  double (*value)(const StageCounters &);
+};
+
+constexpr Field fields[] = {
+    {"elements", "Elements read through the stage",
+     [](const StageCounters &c) { return static_cast<double>(c.elements); }},
+    {"pulls", "Reads and increments of the stage",
+     [](const StageCounters &c) { return static_cast<double>(c.pulls); }},
+    {"ticks", "Ticks spent upstream, estimated from the sampled pulls",
+     [](const StageCounters &c) { return c.estimatedTicks(); }},
+    {"allocations", "Allocations made upstream during pulls",
+     [](const StageCounters &c) {
+       return static_cast<double>(c.allocations);
+     }},
+    {"allocated_bytes", "Bytes allocated upstream during pulls",
+     [](const StageCounters &c) {
+       return static_cast<double>(c.allocatedBytes);
+     }},
+};
+
+std::string number(double x) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.17g", x);
+  return buf;
+}
+} // namespace
+
+double StageCounters::estimatedTicks() const noexcept {
+  if (sampledPulls == 0) {
+    return 0;
+  }
+  return static_cast<double>(sampledTicks) * static_cast<double>(pulls) /
+         static_cast<double>(sampledPulls);
+}
+
+StageCounters &StageCounters::operator+=(const StageCounters &c) noexcept {
+  elements += c.elements;
+  pulls += c.pulls;
+  sampledPulls += c.sampledPulls;
+  sampledTicks += c.sampledTicks;
+  allocations += c.allocations;
+  allocatedBytes += c.allocatedBytes;
+  return *this;
+}
+
+InstrumentRegistry &InstrumentRegistry::global() {
+  static InstrumentRegistry registry;
+  return registry;
+}
+
+void InstrumentRegistry::add(std::string_view stage,
+                             const StageCounters &counters) {
+  const std::lock_guard lock(mutex_);
+  auto it = stages_.find(stage);
+  if (it == stages_.end()) {
+    it = stages_.emplace(std::string(stage), StageCounters{}).first;
+  }
+  it->second += counters;
+}
+
+std::vector<std::pair<std::string, StageCounters>>
+InstrumentRegistry::stages() const {
+  const std::lock_guard lock(mutex_);
+  return {stages_.begin(), stages_.end()};
+}
+
+void InstrumentRegistry::reset() {
+  const std::lock_guard lock(mutex_);
+  stages_.clear();
+}
+
+std::string InstrumentRegistry::json() const {
+  std::string s = "{\"stages\":[";
+  bool first = true;
+  for (const auto &[name, counters] : stages()) {
+    s += first ? "{\"name\":" : ",{\"name\":";
+    first = false;
+    s += quoted(name, true);
+    for (const auto &f : fields) {
+      s += ",\"";
+      s += f.name;
+      s += "\":";
+      s += number(f.value(counters));
+    }
+    s += '}';
+  }
+  s += "]}";
+  return s;
+}
+
+std::string InstrumentRegistry::prometheus() const {
+  const auto all = stages();
+  std::string s;
+  for (const auto &f : fields) {
+    const std::string metric =
+        std::string("try_ranges_stage_") + f.name + "_total";
+    s += "# HELP " + metric + ' ' + f.help + "\n# TYPE " + metric +
+         " counter\n";
+    for (const auto &[name, counters] : all) {
+      s += metric + "{stage=" + quoted(name, false) + "} " +
+           number(f.value(counters)) + '\n';
+    }
+  }
+  return s;
+}
+
+#ifdef TRY_RANGES_INSTRUMENT
+thread_local detail::ThreadAllocations detail::threadAllocations{0, 0};
+
+// Counts what the calling thread allocates, for the stages to take the
+// difference over their pulls. The array and nothrow forms call this one.
+// Not inlined, nor the deletes, GCC would take the free of what it returns
+// for a mismatch.
+[[gnu::noinline]] void *operator new(std::size_t n) {
+  ++detail::threadAllocations.count;
+  detail::threadAllocations.bytes += n;
+  // As the default one, the new handler gets to free memory before we fail
+  void *p = nullptr;
+  while ((p = std::malloc(n == 0 ? 1 : n)) == nullptr) {
+    if (const std::new_handler handler = std::get_new_handler()) {
+      handler();
+    } else {
+      throw std::bad_alloc();
+    }
+  }
+  return p;
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+#endif
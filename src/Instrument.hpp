@@ -0,0 +1,374 @@
+#pragma once
+
+#include <range/v3/iterator/concepts.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/range/traits.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef TRY_RANGES_INSTRUMENT
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+// Per stage counters of a range pipeline, to find the stage that makes it
+// slow: s | instrument("trim") | rv::transform(trim) | instrument("lower")
+// ... counts under each name what the stage after it pulls through it, the
+// elements, the time upstream takes to produce them and what it allocates.
+// Compiled in with the TRY_RANGES_INSTRUMENT CMake option, without it
+// instrument(name) is views::all and the registry stays empty.
+
+// What the pulls through one instrument(name) cost, the upstream stages'
+// work included. Time is sampled, every sampleEvery-th pull, in ticks: TSC
+// cycles on x86, steady_clock nanoseconds elsewhere. Allocations are those
+// of operator new on the pulling thread during every pull, aligned ones
+// aside.
+struct StageCounters {
+  static constexpr std::uint64_t sampleEvery = 64;
+
+  // Elements read through the stage, each once however often it is read
+  std::uint64_t elements = 0;
+  // Reads and increments, what is sampled
+  std::uint64_t pulls = 0;
+  std::uint64_t sampledPulls = 0;
+  std::uint64_t sampledTicks = 0;
+  std::uint64_t allocations = 0;
+  std::uint64_t allocatedBytes = 0;
+
+  // sampledTicks scaled up to all pulls
+  [[nodiscard]] double estimatedTicks() const noexcept;
+
+  StageCounters &operator+=(const StageCounters &c) noexcept;
+};
+
+// The counters of every stage by name, an instrument view adds its own when
+// it is destroyed
+class InstrumentRegistry {
+public:
+  // The one instrument views add to
+  [[nodiscard]] static InstrumentRegistry &global();
+
+  void add(std::string_view stage, const StageCounters &counters);
+  // By name
+  [[nodiscard]] std::vector<std::pair<std::string, StageCounters>>
+  stages() const;
+  void reset();
+
+  // {"stages":[{"name":"trim","elements":...},...]}
+  [[nodiscard]] std::string json() const;
+  // The Prometheus text format, a counter per field labelled by stage
+  [[nodiscard]] std::string prometheus() const;
+
+private:
+  mutable std::mutex mutex_;
+  std::map<std::string, StageCounters, std::less<>> stages_;
+};
+
+#ifdef TRY_RANGES_INSTRUMENT
+namespace detail {
+// Counted by the operator new of Instrument.cpp
+struct ThreadAllocations {
+  std::uint64_t count;
+  std::uint64_t bytes;
+};
+extern thread_local ThreadAllocations threadAllocations;
+
+[[nodiscard]] inline std::uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Measures the pull it lives through
+class StageProbe {
+public:
+  explicit StageProbe(StageCounters &c) noexcept
+      : c_(&c), count_(threadAllocations.count),
+        bytes_(threadAllocations.bytes),
+        start_(c.pulls++ % StageCounters::sampleEvery == 0 ? ticks() : 0) {}
+  StageProbe(const StageProbe &) = delete;
+  StageProbe &operator=(const StageProbe &) = delete;
+  ~StageProbe() {
+    if (start_ != 0) {
+      c_->sampledTicks += ticks() - start_;
+      ++c_->sampledPulls;
+    }
+    c_->allocations += threadAllocations.count - count_;
+    c_->allocatedBytes += threadAllocations.bytes - bytes_;
+  }
+
+private:
+  StageCounters *c_;
+  std::uint64_t count_;
+  std::uint64_t bytes_;
+  std::uint64_t start_;
+};
+} // namespace detail
+
+// The elements of V, counted into the registry under name. The counters are
+// kept in the view and added once it is destroyed, a copy starts from zero.
+// The view keeps the iterator category of V up to random access, a
+// contiguous V is random access through it, and is common and sized when V
+// is, so that a pipeline behaves the same with the option on and off.
+template <typename V>
+  requires ranges::input_range<V> && ranges::view_<V>
+class instrument_view : public ranges::view_interface<instrument_view<V>> {
+  using Base = ranges::iterator_t<V>;
+  using End = ranges::sentinel_t<V>;
+
+public:
+  class iterator {
+  public:
+    using value_type = ranges::range_value_t<V>;
+    using difference_type = ranges::range_difference_t<V>;
+    using iterator_concept = std::conditional_t<
+        ranges::random_access_range<V>, std::random_access_iterator_tag,
+        std::conditional_t<
+            ranges::bidirectional_range<V>, std::bidirectional_iterator_tag,
+            std::conditional_t<ranges::forward_range<V>,
+                               std::forward_iterator_tag,
+                               std::input_iterator_tag>>>;
+
+    iterator() = default;
+
+    // An element read again, as a filter after this does, counts once per
+    // visit of its position
+    ranges::range_reference_t<V> operator*() const {
+      const detail::StageProbe probe(parent_->counters_);
+      if (!read_) {
+        read_ = true;
+        ++parent_->counters_.elements;
+      }
+      return *it_;
+    }
+    ranges::range_reference_t<V> operator[](difference_type n) const
+      requires ranges::random_access_range<V>
+    {
+      return *(*this + n);
+    }
+
+    iterator &operator++() {
+      const detail::StageProbe probe(parent_->counters_);
+      ++it_;
+      read_ = false;
+      return *this;
+    }
+    void operator++(int)
+      requires(!ranges::forward_range<V>)
+    {
+      ++*this;
+    }
+    iterator operator++(int)
+      requires ranges::forward_range<V>
+    {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+    iterator &operator--()
+      requires ranges::bidirectional_range<V>
+    {
+      const detail::StageProbe probe(parent_->counters_);
+      --it_;
+      read_ = false;
+      return *this;
+    }
+    iterator operator--(int)
+      requires ranges::bidirectional_range<V>
+    {
+      auto old = *this;
+      --*this;
+      return old;
+    }
+    iterator &operator+=(difference_type n)
+      requires ranges::random_access_range<V>
+    {
+      const detail::StageProbe probe(parent_->counters_);
+      it_ += n;
+      read_ = false;
+      return *this;
+    }
+    iterator &operator-=(difference_type n)
+      requires ranges::random_access_range<V>
+    {
+      return *this += -n;
+    }
+    friend iterator operator+(iterator i, difference_type n)
+      requires ranges::random_access_range<V>
+    {
+      return i += n;
+    }
+    friend iterator operator+(difference_type n, iterator i)
+      requires ranges::random_access_range<V>
+    {
+      return i += n;
+    }
+    friend iterator operator-(iterator i, difference_type n)
+      requires ranges::random_access_range<V>
+    {
+      return i -= n;
+    }
+    friend difference_type operator-(const iterator &a, const iterator &b)
+      requires ranges::sized_sentinel_for<Base, Base>
+    {
+      return a.it_ - b.it_;
+    }
+    friend difference_type operator-(const End &end, const iterator &a)
+      requires(!ranges::common_range<V> &&
+               ranges::sized_sentinel_for<End, Base>)
+    {
+      return end - a.it_;
+    }
+    friend difference_type operator-(const iterator &a, const End &end)
+      requires(!ranges::common_range<V> &&
+               ranges::sized_sentinel_for<End, Base>)
+    {
+      return a.it_ - end;
+    }
+
+    friend bool operator==(const iterator &a, const iterator &b)
+      requires ranges::forward_range<V> || ranges::common_range<V>
+    {
+      return a.it_ == b.it_;
+    }
+    friend bool operator==(const iterator &a, const End &end)
+      requires(!ranges::common_range<V>)
+    {
+      return a.it_ == end;
+    }
+    friend bool operator<(const iterator &a, const iterator &b)
+      requires ranges::random_access_range<V>
+    {
+      return a.it_ < b.it_;
+    }
+    friend bool operator>(const iterator &a, const iterator &b)
+      requires ranges::random_access_range<V>
+    {
+      return b < a;
+    }
+    friend bool operator<=(const iterator &a, const iterator &b)
+      requires ranges::random_access_range<V>
+    {
+      return !(b < a);
+    }
+    friend bool operator>=(const iterator &a, const iterator &b)
+      requires ranges::random_access_range<V>
+    {
+      return !(a < b);
+    }
+
+  private:
+    friend instrument_view;
+    iterator(instrument_view &parent, Base it)
+        : parent_(&parent), it_(std::move(it)) {}
+
+    instrument_view *parent_ = nullptr;
+    Base it_{};
+    mutable bool read_ = false;
+  };
+
+  instrument_view() = default;
+  instrument_view(V base, std::string name)
+      : base_(std::move(base)), name_(std::move(name)) {}
+  instrument_view(const instrument_view &v) : base_(v.base_), name_(v.name_) {}
+  instrument_view(instrument_view &&v)
+      : base_(std::move(v.base_)), name_(std::move(v.name_)),
+        counters_(std::exchange(v.counters_, {})) {}
+  instrument_view &operator=(const instrument_view &v) {
+    if (this != &v) {
+      flush();
+      base_ = v.base_;
+      name_ = v.name_;
+    }
+    return *this;
+  }
+  instrument_view &operator=(instrument_view &&v) {
+    if (this != &v) {
+      flush();
+      base_ = std::move(v.base_);
+      name_ = std::move(v.name_);
+      counters_ = std::exchange(v.counters_, {});
+    }
+    return *this;
+  }
+  ~instrument_view() { flush(); }
+
+  [[nodiscard]] iterator begin() { return {*this, ranges::begin(base_)}; }
+  [[nodiscard]] iterator end()
+    requires ranges::common_range<V>
+  {
+    return {*this, ranges::end(base_)};
+  }
+  [[nodiscard]] End end()
+    requires(!ranges::common_range<V>)
+  {
+    return ranges::end(base_);
+  }
+  [[nodiscard]] auto size()
+    requires ranges::sized_range<V>
+  {
+    return ranges::size(base_);
+  }
+
+private:
+  void flush() noexcept {
+    if (counters_.pulls != 0) {
+      try {
+        InstrumentRegistry::global().add(name_, counters_);
+      } catch (...) {
+        // Counters aren't worth throwing from a destructor for
+      }
+      counters_ = {};
+    }
+  }
+
+  V base_;
+  std::string name_;
+  StageCounters counters_;
+};
+#endif
+
+namespace detail {
+struct InstrumentFn {
+  std::string_view name;
+
+  template <ranges::input_range R> auto operator()(R &&rng) const {
+#ifdef TRY_RANGES_INSTRUMENT
+    return instrument_view<ranges::views::all_t<R>>(
+        ranges::views::all(std::forward<R>(rng)), std::string(name));
+#else
+    return ranges::views::all(std::forward<R>(rng));
+#endif
+  }
+  template <ranges::input_range R>
+  friend auto operator|(R &&rng, const InstrumentFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+} // namespace detail
+
+// rng | instrument(name), counted into InstrumentRegistry::global()
+[[nodiscard]] constexpr detail::InstrumentFn
+instrument(std::string_view name) noexcept {
+  return {name};
+}
@@ -0,0 +1,145 @@
+#include "Instrument.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// Resets the registry around a test, the stages of others would be in it
+struct RegistryGuard {
+  RegistryGuard() { InstrumentRegistry::global().reset(); }
+  RegistryGuard(const RegistryGuard &) = delete;
+  RegistryGuard &operator=(const RegistryGuard &) = delete;
+  ~RegistryGuard() { InstrumentRegistry::global().reset(); }
+};
+} // namespace
+
+TEST_CASE("instrument") {
+  const RegistryGuard guard;
+  std::vector<int> v(1000);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    v[i] = static_cast<int>(i);
+  }
+  const auto even = [](int x) { return x % 2 == 0; };
+  // Long enough not to fit in the small string buffer
+  const auto label = [](int x) {
+    return std::string(32, 'a') + std::to_string(x);
+  };
+  const auto labels = v | instrument("source") | ranges::views::filter(even) |
+                      instrument("evens") | ranges::views::transform(label) |
+                      instrument("labels") |
+                      ranges::to<std::vector<std::string>>();
+  REQUIRE_EQ(labels.size(), 500U);
+  CHECK_EQ(labels[1], std::string(32, 'a') + "2");
+
+  const auto stages = InstrumentRegistry::global().stages();
+#ifdef TRY_RANGES_INSTRUMENT
+  REQUIRE_EQ(stages.size(), 3U);
+  const auto &[evensName, evens] = stages[0];
+  const auto &[labelsName, labelCounters] = stages[1];
+  const auto &[sourceName, source] = stages[2];
+  CHECK_EQ(evensName, "evens");
+  CHECK_EQ(labelsName, "labels");
+  CHECK_EQ(sourceName, "source");
+  CHECK_EQ(source.elements, 1000U);
+  CHECK_EQ(evens.elements, 500U);
+  CHECK_EQ(labelCounters.elements, 500U);
+  CHECK_GE(labelCounters.allocations, 500U);
+  CHECK_GE(labelCounters.allocatedBytes, 500U * 33U);
+  CHECK_EQ(evens.allocations, 0U);
+  CHECK_GT(labelCounters.sampledPulls, 0U);
+  CHECK_GT(labelCounters.estimatedTicks(), 0.0);
+#else
+  CHECK_UNARY(stages.empty());
+  CHECK_UNARY((std::is_same_v<decltype(v | instrument("source")),
+                              decltype(ranges::views::all(v))>));
+#endif
+}
+
+TEST_CASE("instrument keeps the kind of range") {
+  const RegistryGuard guard;
+  std::vector<int> v{1, 2, 3, 4};
+  const auto odd = [](int x) { return x % 2 != 0; };
+  using Instrumented = decltype(v | instrument("v"));
+  static_assert(ranges::random_access_range<Instrumented>);
+  static_assert(ranges::common_range<Instrumented>);
+  static_assert(ranges::sized_range<Instrumented>);
+  using Filtered =
+      decltype(v | ranges::views::filter(odd) | instrument("odd"));
+  static_assert(ranges::bidirectional_range<Filtered>);
+  static_assert(!ranges::random_access_range<Filtered>);
+  static_assert(ranges::common_range<Filtered>);
+
+  auto r = v | instrument("v");
+  CHECK_EQ(r.end() - r.begin(), 4);
+  CHECK_EQ(r.begin()[2], 3);
+  CHECK_EQ(*--r.end(), 4);
+  CHECK_UNARY(r.begin() < r.end());
+}
+
+TEST_CASE("InstrumentRegistry json and prometheus") {
+  const RegistryGuard guard;
+  auto &registry = InstrumentRegistry::global();
+  CHECK_EQ(registry.json(), "{\"stages\":[]}");
+  StageCounters c;
+  c.elements = 3;
+  c.pulls = 8;
+  c.sampledPulls = 2;
+  c.sampledTicks = 50;
+  c.allocations = 1;
+  c.allocatedBytes = 40;
+  registry.add("trim", c);
+  registry.add("trim", c);
+  registry.add("say \"hi\"\n", c);
+  CHECK_EQ(registry.json(),
+           "{\"stages\":["
+           "{\"name\":\"say \\\"hi\\\"\\n\",\"elements\":3,\"pulls\":8,"
+           "\"ticks\":200,\"allocations\":1,\"allocated_bytes\":40},"
+           "{\"name\":\"trim\",\"elements\":6,\"pulls\":16,"
+           "\"ticks\":400,\"allocations\":2,\"allocated_bytes\":80}]}");
+  const std::string text = registry.prometheus();
+  CHECK_NE(text.find("# TYPE try_ranges_stage_elements_total counter\n"
+                     "try_ranges_stage_elements_total"
+                     "{stage=\"say \\\"hi\\\"\\n\"} 3\n"
+                     "try_ranges_stage_elements_total{stage=\"trim\"} 6\n"),
+           std::string::npos);
+  CHECK_NE(text.find("try_ranges_stage_ticks_total{stage=\"trim\"} 400\n"),
+           std::string::npos);
+}
+
+// ASan aborts on an allocation it can't serve instead of failing it
+#if defined(__SANITIZE_ADDRESS__)
+#define TRY_RANGES_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define TRY_RANGES_ASAN
+#endif
+#endif
+
+#if defined(TRY_RANGES_INSTRUMENT) && !defined(TRY_RANGES_ASAN)
+namespace {
+int handlerCalls = 0;
+void throwingHandler() {
+  ++handlerCalls;
+  throw std::bad_alloc();
+}
+} // namespace
+
+TEST_CASE("the counting operator new calls the new handler") {
+  const std::new_handler previous = std::set_new_handler(throwingHandler);
+  // More than malloc can give
+  CHECK_THROWS_AS((void)::operator new(static_cast<std::size_t>(-1) / 2),
+                  std::bad_alloc);
+  std::set_new_handler(previous);
+  CHECK_EQ(handlerCalls, 1);
+}
+#endif
@@ -0,0 +1,65 @@
+#include "LineIndex.hpp"
+
+#include "Simd.hpp"
+#include "Utils.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+template <typename T>
+std::shared_ptr<const std::vector<T>> buildEnds(std::string_view text) {
+  auto ends = std::make_shared<std::vector<T>>();
+  ends->reserve(countLines(text));
+  simd::forEachMatch(text, '\n', [&](std::size_t pos) {
+    ends->push_back(static_cast<T>(pos));
+  });
+  if (!text.empty() && text.back() != '\n') {
+    ends->push_back(static_cast<T>(text.size()));
+  }
+  return ends;
+}
+} // namespace
+
+LineIndex::LineIndex(std::string_view text, OffsetWidth width) : text_(text) {
+  constexpr auto max32 = std::numeric_limits<std::uint32_t>::max();
+  const bool fits32 = text.size() <= max32;
+  if (width == OffsetWidth::Bits32 && !fits32) {
+    throw std::length_error("LineIndex: buffer too large for 32 bit offsets");
+  }
+  wide_ = width == OffsetWidth::Bits64 || !fits32;
+  if (wide_) {
+    auto ends = buildEnds<std::uint64_t>(text);
+    ends64_ = *ends;
+    owner_ = std::move(ends);
+  } else {
+    auto ends = buildEnds<std::uint32_t>(text);
+    ends32_ = *ends;
+    owner_ = std::move(ends);
+  }
+}
+
+LineIndex::LineIndex(std::string_view text, std::span<const std::uint32_t> ends,
+                     std::shared_ptr<const void> owner)
+    : text_(text), ends32_(ends), owner_(std::move(owner)) {
+  checkLastEnd();
+}
+
+LineIndex::LineIndex(std::string_view text, std::span<const std::uint64_t> ends,
+                     std::shared_ptr<const void> owner)
+    : text_(text), wide_(true), ends64_(ends), owner_(std::move(owner)) {
+  checkLastEnd();
+}
+
+void LineIndex::checkLastEnd() const {
+  const bool valid =
+      empty() ? text_.empty()
+              : endAt(size() - 1) == text_.size() ||
+                    (endAt(size() - 1) + 1 == text_.size() &&
+                     text_.back() == '\n');
+  if (!valid) {
+    throw std::invalid_argument("LineIndex: offsets do not match the text");
+  }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
+
+// The lines of a buffer, as splitLines returns them, stored as one end
+// offset per line instead of a 16 byte std::string_view. Offsets are 32 bit
+// when the buffer is below 4 GiB and 64 bit otherwise. Copies share the
+// offsets, which are immutable.
+class LineIndex {
+public:
+  enum class OffsetWidth { Auto, Bits32, Bits64 };
+
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::string_view operator*() const { return (*index_)[i_]; }
+    std::string_view operator[](difference_type n) const {
+      return (*index_)[static_cast<std::size_t>(
+          static_cast<difference_type>(i_) + n)];
+    }
+    iterator &operator++() {
+      ++i_;
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++i_;
+      return tmp;
+    }
+    iterator &operator--() {
+      --i_;
+      return *this;
+    }
+    iterator operator--(int) {
+      auto tmp = *this;
+      --i_;
+      return tmp;
+    }
+    iterator &operator+=(difference_type n) {
+      i_ = static_cast<std::size_t>(static_cast<difference_type>(i_) + n);
+      return *this;
+    }
+    iterator &operator-=(difference_type n) { return *this += -n; }
+    friend iterator operator+(iterator it, difference_type n) { return it += n; }
+    friend iterator operator+(difference_type n, iterator it) { return it += n; }
+    friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const iterator &a, const iterator &b) {
+      return static_cast<difference_type>(a.i_) -
+             static_cast<difference_type>(b.i_);
+    }
+    friend bool operator==(const iterator &a, const iterator &b) {
+      return a.i_ == b.i_;
+    }
+    friend std::strong_ordering operator<=>(const iterator &a,
+                                            const iterator &b) {
+      return a.i_ <=> b.i_;
+    }
+
+  private:
+    friend LineIndex;
+    iterator(const LineIndex *index, std::size_t i) : index_(index), i_(i) {}
+
+    const LineIndex *index_ = nullptr;
+    std::size_t i_ = 0;
+  };
+
+  LineIndex() = default;
+  // text must outlive the index. Throws std::length_error if Bits32 is
+  // forced on a buffer of 4 GiB or more
+  explicit LineIndex(std::string_view text,
+                     OffsetWidth width = OffsetWidth::Auto);
+  // Adopts end offsets that owner keeps alive, e.g. a mapped sidecar file.
+  // Only the last offset is checked against text, the others are trusted,
+  // std::invalid_argument is thrown if it does not match.
+  LineIndex(std::string_view text, std::span<const std::uint32_t> ends,
+            std::shared_ptr<const void> owner);
+  LineIndex(std::string_view text, std::span<const std::uint64_t> ends,
+            std::shared_ptr<const void> owner);
+
+  [[nodiscard]] std::string_view operator[](std::size_t i) const {
+    const std::size_t first = i == 0 ? 0 : endAt(i - 1) + 1;
+    return text_.substr(first, endAt(i) - first);
+  }
+  [[nodiscard]] std::size_t size() const noexcept {
+    return wide_ ? ends64_.size() : ends32_.size();
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  [[nodiscard]] iterator begin() const { return {this, 0}; }
+  [[nodiscard]] iterator end() const { return {this, size()}; }
+
+  [[nodiscard]] std::string_view text() const noexcept { return text_; }
+  // Bytes of index per line, 4 or 8
+  [[nodiscard]] std::size_t offsetBytes() const noexcept {
+    return wide_ ? sizeof(std::uint64_t) : sizeof(std::uint32_t);
+  }
+  // The end offsets, only the one matching offsetBytes() is non-empty
+  [[nodiscard]] std::span<const std::uint32_t> ends32() const noexcept {
+    return ends32_;
+  }
+  [[nodiscard]] std::span<const std::uint64_t> ends64() const noexcept {
+    return ends64_;
+  }
+
+private:
+  // One past the last char of line i, i.e. its '\n' if it has one
+  [[nodiscard]] std::size_t endAt(std::size_t i) const {
+    return wide_ ? static_cast<std::size_t>(ends64_[i]) : ends32_[i];
+  }
+
+  void checkLastEnd() const;
+
+  std::string_view text_;
+  bool wide_ = false;
+  std::span<const std::uint32_t> ends32_;
+  std::span<const std::uint64_t> ends64_;
+  std::shared_ptr<const void> owner_;
+};
@@ -0,0 +1,154 @@
+#include "LineIndexFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <system_error>
+
+namespace {
+constexpr std::uint64_t Magic = 0x5844'4e49'454e'494cULL; // "LINEINDX"
+constexpr std::uint32_t Version = 1;
+constexpr std::size_t HashedBytes = std::size_t{64} << 10U;
+
+struct Header {
+  std::uint64_t magic;
+  std::uint32_t version;
+  std::uint32_t offsetBytes;
+  std::uint64_t lines;
+  FileStamp stamp;
+};
+static_assert(sizeof(Header) % alignof(std::uint64_t) == 0);
+
+std::uint64_t fnv1a(std::uint64_t h, std::string_view s) {
+  for (const char c : s) {
+    h = (h ^ static_cast<unsigned char>(c)) * 0x100'0000'01b3ULL;
+  }
+  return h;
+}
+
+template <typename T>
+std::optional<LineIndex> adopt(std::shared_ptr<const MappedFile> sidecar,
+                               std::string_view text, std::uint64_t lines) {
+  const auto bytes = sidecar->view().substr(sizeof(Header));
+  const std::size_t count = bytes.size() / sizeof(T);
+  if (bytes.size() % sizeof(T) != 0 || count != lines) {
+    return std::nullopt;
+  }
+  // The mapping is page aligned and the header keeps the offsets aligned
+  const std::span ends(reinterpret_cast<const T *>(bytes.data()), count);
+  try {
+    return LineIndex(text, ends, std::move(sidecar));
+  } catch (const std::invalid_argument &) {
+    return std::nullopt;
+  }
+}
+} // namespace
+
+FileStamp FileStamp::of(const std::filesystem::path &path,
+                        std::string_view content) {
+  FileStamp stamp;
+  stamp.size = content.size();
+  stamp.mtime =
+      std::filesystem::last_write_time(path).time_since_epoch().count();
+  const auto head = content.substr(0, HashedBytes);
+  const auto tail =
+      content.substr(content.size() - std::min(content.size(), HashedBytes));
+  stamp.hash = fnv1a(fnv1a(0xcbf2'9ce4'8422'2325ULL, head), tail);
+  return stamp;
+}
+
+void writeLineIndex(const std::filesystem::path &sidecar,
+                    const LineIndex &index, const FileStamp &stamp) {
+  const Header header{Magic, Version,
+                      static_cast<std::uint32_t>(index.offsetBytes()),
+                      index.size(), stamp};
+  const auto ends = index.offsetBytes() == sizeof(std::uint64_t)
+                        ? std::as_bytes(index.ends64())
+                        : std::as_bytes(index.ends32());
+
+  // Unique, another process or thread may write the same sidecar at once
+  static const auto process = std::random_device{}();
+  static std::atomic<std::uint64_t> written{0};
+  auto tmp = sidecar;
+  tmp += ".tmp." + std::to_string(process) + "." + std::to_string(written++);
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(ends.data()),
+              static_cast<std::streamsize>(ends.size()));
+    out.close();
+    if (!out) {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      throw std::system_error(std::make_error_code(std::errc::io_error),
+                              "write " + tmp.string());
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, sidecar, ec);
+  if (ec) {
+    std::error_code ignored;
+    std::filesystem::remove(tmp, ignored);
+    throw std::system_error(ec, "rename " + tmp.string());
+  }
+}
+
+std::optional<LineIndex> readLineIndex(const std::filesystem::path &sidecar,
+                                       std::string_view text,
+                                       const FileStamp &stamp) {
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(sidecar, ec)) {
+    return std::nullopt;
+  }
+  std::shared_ptr<const MappedFile> file;
+  try {
+    file =
+        std::make_shared<const MappedFile>(sidecar, MappedFile::Advice::Random);
+  } catch (const std::system_error &) {
+    // e.g. unreadable, or replaced while we opened it, a rescan will do
+    return std::nullopt;
+  }
+  if (file->size() < sizeof(Header)) {
+    return std::nullopt;
+  }
+  Header header{};
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (header.magic != Magic || header.version != Version ||
+      header.stamp != stamp) {
+    return std::nullopt;
+  }
+  switch (header.offsetBytes) {
+  case sizeof(std::uint32_t):
+    return adopt<std::uint32_t>(std::move(file), text, header.lines);
+  case sizeof(std::uint64_t):
+    return adopt<std::uint64_t>(std::move(file), text, header.lines);
+  default:
+    return std::nullopt;
+  }
+}
+
+IndexedFile::IndexedFile(const std::filesystem::path &path)
+    : IndexedFile(path, std::filesystem::path(path) += ".lidx") {}
+
+IndexedFile::IndexedFile(const std::filesystem::path &path,
+                         const std::filesystem::path &sidecar)
+    : file_(path) {
+  const auto stamp = FileStamp::of(path, file_.view());
+  if (auto index = readLineIndex(sidecar, file_.view(), stamp)) {
+    lines_ = std::move(*index);
+    reused_ = true;
+    return;
+  }
+  lines_ = LineIndex(file_.view());
+  try {
+    writeLineIndex(sidecar, lines_, stamp);
+  } catch (const std::system_error &) {
+    // e.g. a read-only directory, we just rescan next time
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "LineIndex.hpp"
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+// Identifies an input file version in O(1): its size, mtime and a hash of
+// its first and last 64 KiB
+struct FileStamp {
+  std::uint64_t size = 0;
+  std::int64_t mtime = 0;
+  std::uint64_t hash = 0;
+
+  static FileStamp of(const std::filesystem::path &path,
+                      std::string_view content);
+  friend bool operator==(const FileStamp &, const FileStamp &) = default;
+};
+
+// Sidecar layout: a versioned header holding the stamp of the input, then
+// the end offsets as LineIndex stores them, in native byte order. The file
+// is written under a unique name next to the sidecar and renamed over it.
+void writeLineIndex(const std::filesystem::path &sidecar,
+                    const LineIndex &index, const FileStamp &stamp);
+// Maps the offsets of a sidecar back in for text. nullopt if the sidecar is
+// missing or can't be mapped, from another version or byte order, or
+// stamped for other content.
+std::optional<LineIndex> readLineIndex(const std::filesystem::path &sidecar,
+                                       std::string_view text,
+                                       const FileStamp &stamp);
+
+// A mapped file with its line index, loaded from the sidecar when that is
+// still valid and rebuilt and saved otherwise
+class IndexedFile {
+public:
+  explicit IndexedFile(const std::filesystem::path &path);
+  IndexedFile(const std::filesystem::path &path,
+              const std::filesystem::path &sidecar);
+
+  [[nodiscard]] const MappedFile &file() const noexcept { return file_; }
+  [[nodiscard]] const LineIndex &lines() const noexcept { return lines_; }
+  // Whether the index came from the sidecar instead of a scan
+  [[nodiscard]] bool reused() const noexcept { return reused_; }
+
+private:
+  MappedFile file_;
+  LineIndex lines_;
+  bool reused_ = false;
+};
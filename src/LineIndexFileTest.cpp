@@ -0,0 +1,78 @@
+#include "LineIndexFile.hpp"
+#include "TempFileTestSupport.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("IndexedFile") {
+  const TempDir dir;
+  const auto input = dir.write("input.txt", "abc\n\ndef\nghi");
+  const auto sidecar = std::filesystem::path(input) += ".lidx";
+
+  SUBCASE("first open scans and saves, the second one reuses") {
+    const IndexedFile first(input);
+    CHECK_UNARY_FALSE(first.reused());
+    CHECK_UNARY(std::filesystem::exists(sidecar));
+
+    const IndexedFile second(input);
+    CHECK_UNARY(second.reused());
+    REQUIRE_EQ(second.lines().size(), 4);
+    const auto expected = splitLines(second.file());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      CHECK_EQ(second.lines()[i], expected[i]);
+    }
+  }
+  SUBCASE("changed input invalidates the sidecar") {
+    { const IndexedFile first(input); }
+    dir.write("input.txt", "abc\ndef\nghi\njkl");
+    const IndexedFile second(input);
+    CHECK_UNARY_FALSE(second.reused());
+    CHECK_EQ(second.lines().size(), 4);
+    CHECK_EQ(second.lines()[3], "jkl");
+  }
+  SUBCASE("wide offsets round trip") {
+    const MappedFile f(input);
+    const auto stamp = FileStamp::of(input, f.view());
+    writeLineIndex(sidecar,
+                   LineIndex(f.view(), LineIndex::OffsetWidth::Bits64), stamp);
+    const auto index = readLineIndex(sidecar, f.view(), stamp);
+    REQUIRE_UNARY(index.has_value());
+    CHECK_EQ(index->offsetBytes(), 8);
+    CHECK_EQ((*index)[2], splitLines(f)[2]);
+  }
+  SUBCASE("garbage sidecar is ignored") {
+    dir.write("input.txt.lidx", "not an index");
+    const IndexedFile f(input);
+    CHECK_UNARY_FALSE(f.reused());
+    CHECK_EQ(f.lines().size(), 4);
+    CHECK_UNARY(IndexedFile(input).reused());
+  }
+  SUBCASE("unreadable sidecar is rescanned and saved again") {
+    namespace fs = std::filesystem;
+    const auto locked = dir.write("locked.txt", "abc\ndef");
+    const auto lockedSidecar = fs::path(locked) += ".lidx";
+    { const IndexedFile first(locked); }
+    fs::permissions(lockedSidecar, fs::perms::none);
+    // Root reads it anyway, and the index is reused
+    const bool readable = std::ifstream(lockedSidecar).is_open();
+    const IndexedFile second(locked);
+    CHECK_EQ(second.reused(), readable);
+    REQUIRE_EQ(second.lines().size(), 2);
+    CHECK_EQ(second.lines()[1], "def");
+    // The rescan renamed a fresh sidecar over the locked one
+    CHECK_UNARY(IndexedFile(locked).reused());
+    for (const auto &entry : fs::directory_iterator(dir.path())) {
+      CHECK_EQ(entry.path().filename().string().find(".tmp"),
+               std::string::npos);
+    }
+  }
+  SUBCASE("empty input") {
+    const auto empty = dir.write("empty.txt", "");
+    CHECK_UNARY(IndexedFile(empty).lines().empty());
+    CHECK_UNARY(IndexedFile(empty).reused());
+  }
+}
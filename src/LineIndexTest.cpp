@@ -0,0 +1,57 @@
+#include "LineIndex.hpp"
+#include "LinesTestSupport.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/algorithm/find.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/reverse.hpp>
+
+#include <string>
+
+using namespace std::literals;
+
+static_assert(ranges::random_access_range<LineIndex>);
+static_assert(ranges::sized_range<LineIndex>);
+
+TEST_CASE("LineIndex") {
+  SUBCASE("same lines as splitLines") {
+    for (const auto width :
+         {LineIndex::OffsetWidth::Auto, LineIndex::OffsetWidth::Bits32,
+          LineIndex::OffsetWidth::Bits64}) {
+      for (const auto s : edgeCases) {
+        const LineIndex index(s, width);
+        const auto expected = splitLines(s);
+        REQUIRE_EQ(index.size(), expected.size());
+        for (std::size_t i = 0; i < index.size(); ++i) {
+          CHECK_EQ(index[i], expected[i]);
+          CHECK_EQ(index[i].data(), expected[i].data());
+        }
+        CHECK_EQ(ranges::to<std::vector<std::string_view>>(index), expected);
+      }
+    }
+  }
+  SUBCASE("offset width") {
+    CHECK_EQ(LineIndex("a\nb").offsetBytes(), 4);
+    CHECK_EQ(LineIndex("a\nb", LineIndex::OffsetWidth::Bits64).offsetBytes(),
+             8);
+    CHECK_UNARY(LineIndex().empty());
+  }
+  SUBCASE("random access") {
+    const LineIndex index("abc\n\ndef\nghi\n");
+    auto it = index.begin();
+    CHECK_EQ(it[2], "def");
+    CHECK_EQ(*(it + 3), "ghi");
+    CHECK_EQ(index.end() - it, 4);
+    it += 4;
+    CHECK_EQ(it, index.end());
+    CHECK_EQ(*--it, "ghi");
+    CHECK_LT(index.begin(), it);
+    CHECK_EQ(ranges::find(index, "def"sv) - index.begin(), 2);
+    CHECK_EQ(ranges::to<std::vector<std::string_view>>(index |
+                                                        ranges::views::reverse),
+             (std::vector{"ghi"sv, "def"sv, ""sv, "abc"sv}));
+  }
+}
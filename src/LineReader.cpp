@@ -0,0 +1,85 @@
+#include "LineReader.hpp"
+
+#include "Simd.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+LineReader::LineReader(ReadFn read, std::size_t bufferSize)
+    : read_(std::move(read)), buf_(bufferSize == 0 ? 1 : bufferSize) {}
+
+LineReader::LineReader(int fd, std::size_t bufferSize)
+    : LineReader(
+          [fd](char *buf, std::size_t n) -> std::size_t {
+            for (;;) {
+#ifdef _WIN32
+              const auto r = ::_read(fd, buf, static_cast<unsigned>(n));
+#else
+              const auto r = ::read(fd, buf, n);
+#endif
+              if (r >= 0) {
+                return static_cast<std::size_t>(r);
+              }
+              if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "read");
+              }
+            }
+          },
+          bufferSize) {}
+
+LineReader::LineReader(std::istream &in, std::size_t bufferSize)
+    : LineReader(
+          [&in](char *buf, std::size_t n) {
+            in.read(buf, static_cast<std::streamsize>(n));
+            return static_cast<std::size_t>(in.gcount());
+          },
+          bufferSize) {}
+
+std::optional<std::string_view> LineReader::next() {
+  for (;;) {
+    const std::string_view pending(buf_.data() + scan_, end_ - scan_);
+    if (const auto eol = simd::find(pending, '\n');
+        eol != std::string_view::npos) {
+      const std::string_view line(buf_.data() + begin_, scan_ + eol - begin_);
+      begin_ = scan_ = scan_ + eol + 1;
+      return line;
+    }
+    scan_ = end_;
+    if (!refill()) {
+      if (begin_ == end_) {
+        return std::nullopt;
+      }
+      const std::string_view line(buf_.data() + begin_, end_ - begin_);
+      begin_ = end_;
+      return line;
+    }
+  }
+}
+
+bool LineReader::refill() {
+  if (eof_) {
+    return false;
+  }
+  // Carry the partial line over to the front, the lines handed out so far
+  // are invalidated by the read anyway
+  std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+  scan_ -= begin_;
+  end_ -= begin_;
+  begin_ = 0;
+  if (end_ == buf_.size()) {
+    buf_.resize(buf_.size() * 2);
+  }
+  const std::size_t n = read_(buf_.data() + end_, buf_.size() - end_);
+  end_ += n;
+  eof_ = n == 0;
+  return !eof_;
+}
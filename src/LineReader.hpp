@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Splits a stream into lines like splitLines, reading it through a reusable
+// buffer. A partial line at the end of a chunk is carried over into the next
+// one, so memory stays at the buffer size, or the longest line if that does
+// not fit.
+class LineReader {
+public:
+  static constexpr std::size_t DefaultBufferSize = std::size_t{1} << 20U;
+
+  // Fills up to n bytes, returns 0 at the end of the stream
+  using ReadFn = std::function<std::size_t(char *buf, std::size_t n)>;
+
+  explicit LineReader(ReadFn read, std::size_t bufferSize = DefaultBufferSize);
+  // Reads from a file descriptor, e.g. a pipe or a socket. Throws
+  // std::system_error on read errors
+  explicit LineReader(int fd, std::size_t bufferSize = DefaultBufferSize);
+  explicit LineReader(std::istream &in,
+                      std::size_t bufferSize = DefaultBufferSize);
+
+  // The next line, valid until the next call, or nullopt at the end
+  std::optional<std::string_view> next();
+
+  // An input range over the remaining lines
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::string_view operator*() const { return *line_; }
+    iterator &operator++() {
+      line_ = reader_->next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return !it.line_.has_value();
+    }
+
+  private:
+    friend LineReader;
+    explicit iterator(LineReader &reader)
+        : reader_(&reader), line_(reader.next()) {}
+
+    LineReader *reader_ = nullptr;
+    std::optional<std::string_view> line_;
+  };
+
+  [[nodiscard]] iterator begin() { return iterator(*this); }
+  [[nodiscard]] std::default_sentinel_t end() const { return {}; }
+
+private:
+  bool refill();
+
+  ReadFn read_;
+  std::vector<char> buf_;
+  std::size_t begin_ = 0; // first byte of the current partial line
+  std::size_t scan_ = 0;  // no '\n' in [begin_, scan_)
+  std::size_t end_ = 0;   // end of the valid data
+  bool eof_ = false;
+};
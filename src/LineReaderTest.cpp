@@ -0,0 +1,83 @@
+#include "LineReader.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <thread>
+#include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace {
+std::vector<std::string> readAll(std::string_view s, std::size_t bufferSize) {
+  std::istringstream in{std::string(s)};
+  LineReader reader(in, bufferSize);
+  std::vector<std::string> lines;
+  while (const auto line = reader.next()) {
+    lines.emplace_back(*line);
+  }
+  return lines;
+}
+
+std::vector<std::string> toStrings(const std::vector<std::string_view> &v) {
+  return {v.begin(), v.end()};
+}
+} // namespace
+
+TEST_CASE("LineReader") {
+  SUBCASE("splits like splitLines for any buffer size") {
+    for (const auto s : {""sv, "\n"sv, "\n\n"sv, "abc"sv, "abc\n"sv,
+                         "\nabc"sv, "\nabc\n"sv, "abc\ndef"sv,
+                         "abc\ndef\n"sv, "abc\n\ndef\nghi\n"sv}) {
+      for (const std::size_t bufferSize : {1U, 2U, 3U, 4U, 64U}) {
+        CHECK_EQ(readAll(s, bufferSize), toStrings(splitLines(s)));
+      }
+    }
+  }
+  SUBCASE("lines longer than the buffer grow it") {
+    const auto s = std::string(100, 'x') + "\nab\n" + std::string(50, 'y');
+    CHECK_EQ(readAll(s, 8), toStrings(splitLines(s)));
+  }
+  SUBCASE("works as an input range") {
+    std::istringstream in("apple\n\nbanana\nkiwi\n");
+    LineReader reader(in, 4);
+    namespace rg = ranges;
+    namespace rv = ranges::views;
+    const auto sizes =
+        reader | rv::filter([](std::string_view l) { return !l.empty(); }) |
+        rv::transform([](std::string_view l) { return l.size(); }) |
+        rg::to<std::vector<std::size_t>>();
+    CHECK_EQ(sizes, (std::vector<std::size_t>{5, 6, 4}));
+  }
+#ifndef _WIN32
+  SUBCASE("reads from a pipe") {
+    int fds[2];
+    REQUIRE_EQ(::pipe(fds), 0);
+    std::thread writer([fd = fds[1]] {
+      for (int i = 0; i < 1000; ++i) {
+        const auto line = std::to_string(i) + "\n";
+        CHECK_EQ(::write(fd, line.data(), line.size()),
+                 static_cast<ssize_t>(line.size()));
+      }
+      ::close(fd);
+    });
+    LineReader reader(fds[0], 16);
+    int expected = 0;
+    for (const auto line : reader) {
+      CHECK_EQ(line, std::to_string(expected++));
+    }
+    CHECK_EQ(expected, 1000);
+    writer.join();
+    ::close(fds[0]);
+  }
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+// Test inputs for code splitting text into lines
+
+// The edge cases of line splitting: empty lines, and text with and without
+// a final newline, for checking other splitters against splitLines
+inline constexpr auto edgeCases = std::to_array<std::string_view>(
+    {"", "\n", "\n\n", "abc", "abc\n", "\nabc", "\nabc\n", "abc\ndef",
+     "abc\ndef\n", "abc\n\ndef\nghi\n"});
@@ -0,0 +1,175 @@
+#include "MappedFile.hpp"
+
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+[[noreturn]] void throwLastError(const std::string &what) {
+  throw std::system_error(static_cast<int>(::GetLastError()),
+                          std::system_category(), what);
+}
+
+struct Handle {
+  HANDLE h;
+  explicit Handle(HANDLE handle) : h(handle) {}
+  Handle(const Handle &) = delete;
+  Handle &operator=(const Handle &) = delete;
+  ~Handle() {
+    if (h != nullptr && h != INVALID_HANDLE_VALUE) {
+      ::CloseHandle(h);
+    }
+  }
+};
+#else
+[[noreturn]] void throwErrno(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+struct Fd {
+  int fd;
+  explicit Fd(int f) : fd(f) {}
+  Fd(const Fd &) = delete;
+  Fd &operator=(const Fd &) = delete;
+  ~Fd() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+#endif
+} // namespace
+
+MappedFile::MappedFile(const std::filesystem::path &path, Advice advice) {
+#ifdef _WIN32
+  const Handle file{::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING,
+                                  advice == Advice::Random
+                                      ? FILE_FLAG_RANDOM_ACCESS
+                                      : FILE_FLAG_SEQUENTIAL_SCAN,
+                                  nullptr)};
+  if (file.h == INVALID_HANDLE_VALUE) {
+    throwLastError("open " + path.string());
+  }
+  if (::GetFileType(file.h) != FILE_TYPE_DISK) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+                            "map " + path.string() + ": not a regular file");
+  }
+  LARGE_INTEGER size;
+  if (::GetFileSizeEx(file.h, &size) == 0) {
+    throwLastError("stat " + path.string());
+  }
+  if (size.QuadPart == 0) {
+    return;
+  }
+  const Handle mapping{
+      ::CreateFileMappingW(file.h, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+  if (mapping.h == nullptr) {
+    throwLastError("map " + path.string());
+  }
+  void *p = ::MapViewOfFile(mapping.h, FILE_MAP_READ, 0, 0, 0);
+  if (p == nullptr) {
+    throwLastError("map " + path.string());
+  }
+  data_ = static_cast<const char *>(p);
+  size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+  // Non-blocking so that opening a FIFO without a writer fails below instead
+  // of waiting for one, mapping a regular file doesn't read through the fd
+  const Fd file{::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK)};
+  if (file.fd < 0) {
+    throwErrno("open " + path.string());
+  }
+  struct stat st {};
+  if (::fstat(file.fd, &st) != 0) {
+    throwErrno("stat " + path.string());
+  }
+  // A FIFO, device or procfs file has no size to map, it would look empty
+  if (!S_ISREG(st.st_mode)) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+                            "mmap " + path.string() + ": not a regular file");
+  }
+  if (st.st_size == 0) {
+    return;
+  }
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+  if (p == MAP_FAILED) {
+    throwErrno("mmap " + path.string());
+  }
+  data_ = static_cast<const char *>(p);
+  size_ = size;
+#endif
+  advise(advice);
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+void MappedFile::advise(Advice advice) const noexcept {
+  if (empty()) {
+    return;
+  }
+#ifdef _WIN32
+  // Only prefetching has an equivalent, the rest is decided at open time
+  if (advice == Advice::WillNeed) {
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<char *>(data_), size_};
+    ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+  }
+#else
+  void *p = const_cast<char *>(data_);
+  switch (advice) {
+  case Advice::Normal:
+    ::madvise(p, size_, MADV_NORMAL);
+    break;
+  case Advice::Sequential:
+    // Only a more aggressive read-ahead, a WILLNEED here would read the
+    // whole file into the page cache up front
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+    break;
+  case Advice::WillNeed:
+    ::madvise(p, size_, MADV_WILLNEED);
+    break;
+  case Advice::Random:
+    ::madvise(p, size_, MADV_RANDOM);
+    break;
+  }
+#endif
+}
+
+void MappedFile::unmap() noexcept {
+  if (data_ == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  ::UnmapViewOfFile(data_);
+#else
+  ::munmap(const_cast<char *>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
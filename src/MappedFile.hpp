@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on demand,
+// the Sequential hint only makes the read-ahead more aggressive. Nothing is
+// dropped behind the reader: the pages read stay mapped, clean, for the
+// kernel to reclaim under memory pressure.
+class MappedFile {
+public:
+  enum class Advice { Normal, Sequential, WillNeed, Random };
+
+  MappedFile() = default;
+  // Throws std::system_error if the file cannot be opened or mapped, or is
+  // not a regular file
+  explicit MappedFile(const std::filesystem::path &path,
+                      Advice advice = Advice::Sequential);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  ~MappedFile();
+
+  // Hints the kernel about the upcoming access pattern, best effort
+  void advise(Advice advice) const noexcept;
+
+  [[nodiscard]] const char *data() const noexcept { return data_; }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+
+private:
+  void unmap() noexcept;
+
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
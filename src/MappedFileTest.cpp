@@ -0,0 +1,48 @@
+#include "MappedFile.hpp"
+#include "TempFileTestSupport.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <system_error>
+
+TEST_CASE("MappedFile") {
+  SUBCASE("exposes the file content") {
+    const TempFile tmp("abc\n\ndef\nghi\n");
+    const MappedFile f(tmp.path());
+    CHECK_EQ(f.size(), 13);
+    CHECK_EQ(f.view(), "abc\n\ndef\nghi\n");
+    const auto lines = splitLines(f);
+    CHECK_EQ(lines, splitLines(f.view()));
+    CHECK_EQ(lines.size(), 4);
+    CHECK_EQ(lines[3], "ghi");
+  }
+  SUBCASE("empty file yields no lines") {
+    const TempFile tmp("");
+    const MappedFile f(tmp.path(), MappedFile::Advice::Random);
+    CHECK_UNARY(f.empty());
+    CHECK_UNARY(splitLines(f).empty());
+  }
+  SUBCASE("move transfers the mapping") {
+    const TempFile tmp("abc");
+    MappedFile f(tmp.path());
+    const char *data = f.data();
+    MappedFile g(std::move(f));
+    CHECK_EQ(g.data(), data);
+    CHECK_EQ(g.view(), "abc");
+    g = MappedFile();
+    CHECK_UNARY(g.empty());
+  }
+  SUBCASE("missing file throws") {
+    CHECK_THROWS_AS(MappedFile("/nonexistent/try-ranges.txt"),
+                    std::system_error);
+  }
+  SUBCASE("not a regular file throws") {
+    CHECK_THROWS_AS(MappedFile(std::filesystem::temp_directory_path()),
+                    std::system_error);
+#ifndef _WIN32
+    CHECK_THROWS_AS(MappedFile("/dev/null"), std::system_error);
+#endif
+  }
+}
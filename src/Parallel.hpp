@@ -0,0 +1,541 @@
+#pragma once
+
+#include "Executor.hpp"
+#include "Search.hpp"
+#include "Simd.hpp"
+
+#include <range/v3/functional/arithmetic.hpp>
+#include <range/v3/functional/comparisons.hpp>
+#include <range/v3/functional/identity.hpp>
+#include <range/v3/functional/invoke.hpp>
+#include <range/v3/iterator/operations.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/traits.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Range algorithms over random access sized ranges that cut the input into
+// chunks run on an Executor. Each takes a grain, the fewest elements worth a
+// chunk, and inputs of less than two grains run serially on the caller.
+namespace par {
+
+inline constexpr std::size_t defaultGrain = std::size_t{1} << 15U;
+
+namespace detail {
+// Chunks for n elements, a few per thread to balance uneven ones, but never
+// less than grain elements each. 1 means serial.
+[[nodiscard]] inline std::size_t chunkCount(const Executor &ex, std::size_t n,
+                                            std::size_t grain) noexcept {
+  if (ex.concurrency() <= 1) {
+    return 1;
+  }
+  return std::max<std::size_t>(
+      std::min(n / std::max<std::size_t>(grain, 1), ex.concurrency() * 4), 1);
+}
+
+// Start of chunk i of chunks over n elements, the last one ends at n
+[[nodiscard]] inline std::size_t chunkStart(std::size_t n, std::size_t chunks,
+                                            std::size_t i) noexcept {
+  return n / chunks * i + std::min(i, n % chunks);
+}
+
+template <typename It> [[nodiscard]] It at(It first, std::size_t i) {
+  return first + static_cast<std::iter_difference_t<It>>(i);
+}
+
+template <typename R> [[nodiscard]] std::size_t size(R &&rng) {
+  return static_cast<std::size_t>(ranges::distance(rng));
+}
+
+// Calls f(first, last) on every chunk of [first, first + n) concurrently,
+// f(i, first, last) if it also wants the chunk index
+template <typename It, typename F>
+void forEachChunk(Executor &ex, It first, std::size_t n, std::size_t chunks,
+                  F &&f) {
+  parallelFor(ex, chunks, [&](std::size_t i) {
+    const It b = at(first, chunkStart(n, chunks, i));
+    const It e = at(first, chunkStart(n, chunks, i + 1));
+    if constexpr (std::is_invocable_v<F &, std::size_t, It, It>) {
+      f(i, b, e);
+    } else {
+      f(b, e);
+    }
+  });
+}
+
+// Folds the per chunk results of partial(first, last) with op in chunk order
+template <typename T, typename It, typename Partial, typename Op>
+T reduceChunks(Executor &ex, It first, std::size_t n, std::size_t chunks,
+               T init, Partial partial, Op op) {
+  std::vector<T> partials(chunks, init);
+  forEachChunk(ex, first, n, chunks, [&](std::size_t i, It b, It e) {
+    partials[i] = partial(b, e);
+  });
+  for (auto &p : partials) {
+    init = op(std::move(init), std::move(p));
+  }
+  return init;
+}
+
+// How many of the first k elements of the stable merge of [a, a + na) and
+// [b, b + nb) come from a
+template <typename ItA, typename ItB, typename Less>
+[[nodiscard]] std::size_t coRank(ItA a, std::size_t na, ItB b, std::size_t nb,
+                                 std::size_t k, Less &less) {
+  std::size_t lo = k > nb ? k - nb : 0;
+  std::size_t hi = std::min(k, na);
+  while (lo < hi) {
+    const std::size_t i = lo + (hi - lo) / 2;
+    if (less(*at(b, k - i - 1), *at(a, i))) {
+      hi = i;
+    } else {
+      lo = i + 1;
+    }
+  }
+  return lo;
+}
+
+// Merges the neighbouring sorted runs of src, runs[j] to runs[j + 1], in
+// pairs into dst, and halves runs to match. The output is cut into pieces of
+// about step elements so that the last rounds, with few long runs, still keep
+// every thread busy.
+template <typename Src, typename Dst, typename Less>
+void mergeRound(Executor &ex, Src src, Dst dst,
+                std::vector<std::size_t> &runs, std::size_t step, Less &less) {
+  struct Piece {
+    std::size_t lo, mid, hi, k0, k1;
+  };
+  std::vector<Piece> pieces;
+  std::vector<std::size_t> merged{0};
+  for (std::size_t j = 0; j + 1 < runs.size(); j += 2) {
+    const std::size_t lo = runs[j];
+    const std::size_t mid = runs[j + 1];
+    const std::size_t hi = j + 2 < runs.size() ? runs[j + 2] : mid;
+    for (std::size_t k = 0; k < hi - lo; k += step) {
+      pieces.push_back({lo, mid, hi, k, std::min(k + step, hi - lo)});
+    }
+    merged.push_back(hi);
+  }
+  parallelFor(ex, pieces.size(), [&](std::size_t p) {
+    const auto [lo, mid, hi, k0, k1] = pieces[p];
+    const auto a = at(src, lo);
+    const auto b = at(src, mid);
+    const std::size_t i0 = coRank(a, mid - lo, b, hi - mid, k0, less);
+    const std::size_t i1 = coRank(a, mid - lo, b, hi - mid, k1, less);
+    std::merge(std::make_move_iterator(at(a, i0)),
+               std::make_move_iterator(at(a, i1)),
+               std::make_move_iterator(at(b, k0 - i0)),
+               std::make_move_iterator(at(b, k1 - i1)), at(dst, lo + k0),
+               less);
+  });
+  runs = std::move(merged);
+}
+
+// Stable partition of [first, first + n) by pred into outTrue and
+// outFalse(trues), the latter called with the number of true elements once
+// it is known. Returns that number.
+template <typename It, typename OutTrue, typename OutFalse, typename Pred>
+std::size_t partitionCopy(Executor &ex, It first, std::size_t n,
+                          std::size_t chunks, OutTrue outTrue,
+                          OutFalse outFalse, Pred &pred) {
+  std::vector<std::size_t> trues(chunks + 1, 0);
+  forEachChunk(ex, first, n, chunks, [&](std::size_t i, It b, It e) {
+    trues[i + 1] = static_cast<std::size_t>(std::count_if(b, e, pred));
+  });
+  std::partial_sum(trues.begin(), trues.end(), trues.begin());
+  const auto falses = outFalse(trues.back());
+  forEachChunk(ex, first, n, chunks, [&](std::size_t i, It b, It e) {
+    std::partition_copy(b, e, at(outTrue, trues[i]),
+                        at(falses, chunkStart(n, chunks, i) - trues[i]), pred);
+  });
+  return trues.back();
+}
+
+// Whether a scan of It into O with op is a sum simd::prefixSum has a kernel
+// for
+template <typename T, typename It, typename O, typename Op>
+inline constexpr bool simdScan =
+    std::contiguous_iterator<It> && std::contiguous_iterator<O> &&
+    std::same_as<std::iter_value_t<It>, T> &&
+    std::same_as<std::iter_value_t<O>, T> &&
+    (std::same_as<Op, std::plus<>> || std::same_as<Op, std::plus<T>> ||
+     std::same_as<Op, ranges::plus>) &&
+    requires(const T *p, T *o, T x) { simd::prefixSum(p, 0, o, x); };
+
+// Scans [b, e) into o from init, which is op(init, *b) for an inclusive
+// scan and the first output of an exclusive one. Returns the fold of init
+// and all of [b, e).
+template <typename T, typename It, typename O, typename Op>
+T scanChunk(It b, It e, O o, T init, Op &op, bool exclusive) {
+  if constexpr (simdScan<T, It, O, Op>) {
+    return simd::prefixSum(std::to_address(b), static_cast<std::size_t>(e - b),
+                           std::to_address(o), init, exclusive);
+  } else {
+    for (; b != e; ++b, ++o) {
+      // Read before the write, o may be b
+      std::iter_value_t<It> x = *b;
+      if (exclusive) {
+        *o = init;
+        init = op(std::move(init), std::move(x));
+      } else {
+        init = op(std::move(init), std::move(x));
+        *o = init;
+      }
+    }
+    return init;
+  }
+}
+
+// The blocked scan: the chunks are folded concurrently, their totals then
+// in order into the offset every chunk starts from, and the chunks scanned
+// from their offsets concurrently. Without init, as for an inclusive scan,
+// the first chunk starts from its first element.
+template <typename T, typename It, typename O, typename Op>
+void scanChunks(Executor &ex, It first, std::size_t n, std::size_t chunks,
+                O out, std::optional<T> init, Op &op, bool exclusive) {
+  std::vector<std::optional<T>> offsets(chunks);
+  forEachChunk(ex, first, n, chunks, [&](std::size_t i, It b, It e) {
+    if (i + 1 < chunks) {
+      offsets[i + 1] = std::accumulate(b + 1, e, T(*b), op);
+    }
+  });
+  offsets[0] = std::move(init);
+  for (std::size_t i = 1; i < chunks; ++i) {
+    if (offsets[i - 1]) {
+      offsets[i] = op(*offsets[i - 1], std::move(*offsets[i]));
+    }
+  }
+  forEachChunk(ex, first, n, chunks, [&](std::size_t i, It b, It e) {
+    const O o = at(out, chunkStart(n, chunks, i));
+    if (offsets[i]) {
+      scanChunk(b, e, o, *offsets[i], op, exclusive);
+    } else {
+      T x = *b;
+      *o = x;
+      scanChunk(b + 1, e, o + 1, std::move(x), op, false);
+    }
+  });
+}
+} // namespace detail
+
+// rg::accumulate, but op must be associative: the chunks are folded
+// separately, each from its first element, and then into init in order. For
+// floating point the result may differ from the serial sum in the last bits.
+template <typename R, typename T, typename Op = std::plus<>>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+T accumulate(Executor &ex, R &&rng, T init, Op op = {},
+             std::size_t grain = defaultGrain) {
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (chunks == 1) {
+    return std::accumulate(first, detail::at(first, n), std::move(init), op);
+  }
+  return detail::reduceChunks(
+      ex, first, n, chunks, init,
+      [&](auto b, auto e) { return std::accumulate(b + 1, e, T(*b), op); }, op);
+}
+
+// rg::inner_product over the common length of r1 and r2, with the same
+// associativity caveat as accumulate for op1
+template <typename R1, typename R2, typename T, typename Op1 = std::plus<>,
+          typename Op2 = std::multiplies<>>
+  requires ranges::random_access_range<R1> && ranges::sized_range<R1> &&
+           ranges::random_access_range<R2> && ranges::sized_range<R2>
+T inner_product(Executor &ex, R1 &&r1, R2 &&r2, T init, Op1 op1 = {},
+                Op2 op2 = {}, std::size_t grain = defaultGrain) {
+  const auto first1 = ranges::begin(r1);
+  const auto first2 = ranges::begin(r2);
+  const std::size_t n = std::min(detail::size(r1), detail::size(r2));
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (chunks == 1) {
+    return std::inner_product(first1, detail::at(first1, n), first2,
+                              std::move(init), op1, op2);
+  }
+  return detail::reduceChunks(
+      ex, first1, n, chunks, init,
+      [&](auto b, auto e) {
+        const auto b2 =
+            detail::at(first2, static_cast<std::size_t>(b - first1));
+        return std::inner_product(b + 1, e, b2 + 1, T(op2(*b, *b2)), op1, op2);
+      },
+      op1);
+}
+
+template <typename R, typename Pred, typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+ranges::range_difference_t<R> count_if(Executor &ex, R &&rng, Pred pred,
+                                       Proj proj = {},
+                                       std::size_t grain = defaultGrain) {
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  const auto test = [&](auto &&x) {
+    return static_cast<bool>(
+        ranges::invoke(pred, ranges::invoke(proj, std::forward<decltype(x)>(x))));
+  };
+  return detail::reduceChunks(
+      ex, first, n, detail::chunkCount(ex, n, grain),
+      ranges::range_difference_t<R>{0},
+      [&](auto b, auto e) { return std::count_if(b, e, test); }, std::plus<>{});
+}
+
+template <typename R, typename T, typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+ranges::range_difference_t<R> count(Executor &ex, R &&rng, const T &value,
+                                    Proj proj = {},
+                                    std::size_t grain = defaultGrain) {
+  return par::count_if(
+      ex, rng, [&value](const auto &x) { return x == value; }, proj, grain);
+}
+
+// rg::sort as a merge sort: the chunks are sorted concurrently, then merged
+// pairwise through a buffer of n values, each merge split by co-ranking so
+// that the rounds stay parallel up to the last one.
+template <typename R, typename Comp = ranges::less,
+          typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+void sort(Executor &ex, R &&rng, Comp comp = {}, Proj proj = {},
+          std::size_t grain = defaultGrain) {
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  auto less = [&](const auto &a, const auto &b) {
+    return static_cast<bool>(ranges::invoke(comp, ranges::invoke(proj, a),
+                                            ranges::invoke(proj, b)));
+  };
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (chunks == 1) {
+    std::sort(first, detail::at(first, n), less);
+    return;
+  }
+  detail::forEachChunk(ex, first, n, chunks,
+                       [&](auto b, auto e) { std::sort(b, e, less); });
+
+  std::vector<std::size_t> runs(chunks + 1);
+  for (std::size_t i = 0; i <= chunks; ++i) {
+    runs[i] = detail::chunkStart(n, chunks, i);
+  }
+  const std::size_t step = std::max(grain, n / (ex.concurrency() * 4));
+  std::vector<ranges::range_value_t<R>> buffer(n);
+  bool inBuffer = false;
+  while (runs.size() > 2) {
+    if (inBuffer) {
+      detail::mergeRound(ex, buffer.begin(), first, runs, step, less);
+    } else {
+      detail::mergeRound(ex, first, buffer.begin(), runs, step, less);
+    }
+    inBuffer = !inBuffer;
+  }
+  if (inBuffer) {
+    detail::forEachChunk(
+        ex, buffer.begin(), n, chunks, [&](std::size_t i, auto b, auto e) {
+          std::move(b, e, detail::at(first, detail::chunkStart(n, chunks, i)));
+        });
+  }
+}
+
+// rg::partition_copy, stable, into random access outputs with room for the
+// elements. Returns the ends of both outputs.
+template <typename R, typename OutTrue, typename OutFalse, typename Pred,
+          typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R> &&
+           std::random_access_iterator<OutTrue> &&
+           std::random_access_iterator<OutFalse>
+std::pair<OutTrue, OutFalse>
+partition_copy(Executor &ex, R &&rng, OutTrue outTrue, OutFalse outFalse,
+               Pred pred, Proj proj = {}, std::size_t grain = defaultGrain) {
+  const std::size_t n = detail::size(rng);
+  auto test = [&](const auto &x) {
+    return static_cast<bool>(ranges::invoke(pred, ranges::invoke(proj, x)));
+  };
+  const std::size_t trues = detail::partitionCopy(
+      ex, ranges::begin(rng), n, detail::chunkCount(ex, n, grain), outTrue,
+      [&](std::size_t) { return outFalse; }, test);
+  return {detail::at(outTrue, trues), detail::at(outFalse, n - trues)};
+}
+
+// Stable partition through a buffer of n values, returns the iterator to the
+// first element for which pred is false
+template <typename R, typename Pred, typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+ranges::iterator_t<R> partition(Executor &ex, R &&rng, Pred pred,
+                                Proj proj = {},
+                                std::size_t grain = defaultGrain) {
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  auto test = [&](const auto &x) {
+    return static_cast<bool>(ranges::invoke(pred, ranges::invoke(proj, x)));
+  };
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (chunks == 1) {
+    return std::stable_partition(first, detail::at(first, n), test);
+  }
+  std::vector<ranges::range_value_t<R>> buffer(n);
+  const std::size_t trues = detail::partitionCopy(
+      ex, std::make_move_iterator(first), n, chunks, buffer.begin(),
+      [&](std::size_t t) { return detail::at(buffer.begin(), t); }, test);
+  detail::forEachChunk(
+      ex, buffer.begin(), n, chunks, [&](std::size_t i, auto b, auto e) {
+        std::move(b, e, detail::at(first, detail::chunkStart(n, chunks, i)));
+      });
+  return detail::at(first, trues);
+}
+
+// rg::partial_sum, std::inclusive_scan, into a random access out with room
+// for the elements, out may be ranges::begin(rng) to scan in place. op must
+// be associative, as for accumulate. Contiguous sums of the types of
+// simd::prefixSum are scanned with it, chunks or not, a vector at a time.
+// Returns the end of the output.
+template <typename R, typename O, typename Op = std::plus<>>
+  requires ranges::random_access_range<R> && ranges::sized_range<R> &&
+           std::random_access_iterator<O>
+O inclusive_scan(Executor &ex, R &&rng, O out, Op op = {},
+                 std::size_t grain = defaultGrain) {
+  using T = ranges::range_value_t<R>;
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (n == 0) {
+    return out;
+  }
+  if (chunks == 1) {
+    T x = *first;
+    *out = x;
+    detail::scanChunk(first + 1, detail::at(first, n), out + 1, std::move(x),
+                      op, false);
+  } else {
+    detail::scanChunks(ex, first, n, chunks, out, std::optional<T>(), op,
+                       false);
+  }
+  return detail::at(out, n);
+}
+
+// rv::exclusive_scan, std::exclusive_scan: out[i] is init folded with the
+// elements before i, otherwise as inclusive_scan
+template <typename R, typename O, typename T, typename Op = std::plus<>>
+  requires ranges::random_access_range<R> && ranges::sized_range<R> &&
+           std::random_access_iterator<O>
+O exclusive_scan(Executor &ex, R &&rng, O out, T init, Op op = {},
+                 std::size_t grain = defaultGrain) {
+  const auto first = ranges::begin(rng);
+  const std::size_t n = detail::size(rng);
+  const std::size_t chunks = detail::chunkCount(ex, n, grain);
+  if (chunks == 1) {
+    detail::scanChunk(first, detail::at(first, n), out, std::move(init), op,
+                      true);
+  } else {
+    detail::scanChunks(ex, first, n, chunks, out,
+                       std::optional<T>(std::move(init)), op, true);
+  }
+  return detail::at(out, n);
+}
+
+namespace detail {
+// Calls f(chunk, x0) for every value x0 of the outermost variable of a
+// nestedSearch, in chunks of consecutive values claimed by the threads as
+// they go. Nested loops get more work further out, as in a triangle, so
+// there are many chunks per thread to even that out. Returns the chunk
+// count, 0 if there are no values. f returns false to skip the values left.
+template <typename Tuple, typename F>
+std::size_t forEachOuter(Executor &ex, const Tuple &bounds, std::size_t grain,
+                         F f) {
+  const auto [first, last] = ::detail::boundsOf(std::get<0>(bounds));
+  if (last < first) {
+    return 0;
+  }
+  const auto n = static_cast<std::size_t>(last - first) + 1;
+  const std::size_t chunks =
+      ex.concurrency() <= 1
+          ? 1
+          : std::clamp<std::size_t>(n / std::max<std::size_t>(grain, 1), 1,
+                                    ex.concurrency() * 64);
+  parallelFor(ex, chunks, [&](std::size_t c) {
+    for (std::size_t j = chunkStart(n, chunks, c);
+         j < chunkStart(n, chunks, c + 1); ++j) {
+      if (!f(c, first + static_cast<decltype(last - first)>(j))) {
+        return;
+      }
+    }
+  });
+  return chunks;
+}
+
+// The loops inside the outermost variable, at its value x0
+template <typename Tuple, typename Visit, typename X>
+::Step nestedAt(const Tuple &bounds, Visit &visit, const X &x0) {
+  if constexpr (std::tuple_size_v<Tuple> == 1) {
+    return ::detail::visitStep(visit, x0);
+  } else {
+    return ::detail::nestedLoop<1>(bounds, visit, x0);
+  }
+}
+} // namespace detail
+
+// nestedSearch with the values of the outermost variable spread over ex, at
+// least grain of them at a time, so visit must be safe to call
+// concurrently. Each value still has its inner loops run in order on one
+// thread, a Break works as in nestedSearch. A Stop also ends the visits on
+// the other threads, but those that had already started may have run past
+// the point at which a serial search would have stopped.
+template <typename... B, typename Visit>
+  requires(sizeof...(B) > 0)
+bool nested_search(Executor &ex, const std::tuple<B...> &bounds, Visit visit,
+                   std::size_t grain = 1) {
+  std::atomic<bool> stopped{false};
+  auto guarded = [&](const auto &...xs) {
+    if (stopped.load(std::memory_order_relaxed)) {
+      return Step::Stop;
+    }
+    const Step step = ::detail::visitStep(visit, xs...);
+    if (step == Step::Stop) {
+      stopped.store(true, std::memory_order_relaxed);
+    }
+    return step;
+  };
+  detail::forEachOuter(ex, bounds, grain, [&](std::size_t, const auto &x0) {
+    return detail::nestedAt(bounds, guarded, x0) != Step::Stop;
+  });
+  return !stopped.load();
+}
+
+// The values visit(out, x0, ..., xk) pushes to out over a nested_search,
+// in the order a serial nestedSearch would give them. Every chunk of outer
+// values collects into its own vector, so visit only needs to be safe to
+// call concurrently with different outs. It returns void or a Step, but
+// without Step::Stop, whose point in a parallel search is not well defined.
+template <typename T, typename... B, typename Visit>
+  requires(sizeof...(B) > 0)
+std::vector<T> nested_collect(Executor &ex, const std::tuple<B...> &bounds,
+                              Visit visit, std::size_t grain = 1) {
+  std::vector<std::vector<T>> parts(ex.concurrency() <= 1
+                                        ? 1
+                                        : ex.concurrency() * 64);
+  const std::size_t chunks = detail::forEachOuter(
+      ex, bounds, grain, [&](std::size_t c, const auto &x0) {
+        auto into = [&visit, &out = parts[c]](const auto &...xs) {
+          return std::invoke(visit, out, xs...);
+        };
+        detail::nestedAt(bounds, into, x0);
+        return true;
+      });
+  std::vector<T> all;
+  for (std::size_t c = 0; c < chunks; ++c) {
+    all.insert(all.end(), std::make_move_iterator(parts[c].begin()),
+               std::make_move_iterator(parts[c].end()));
+  }
+  return all;
+}
+
+} // namespace par
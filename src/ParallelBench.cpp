@@ -0,0 +1,138 @@
+#include "Bench.hpp"
+#include "Parallel.hpp"
+#include "ThreadPool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace {
+std::vector<double> randomDoubles(const benchmark::State &state) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(0, 1);
+  std::vector<double> v(bench::inputSize(state) / sizeof(double));
+  std::generate(v.begin(), v.end(), [&] { return dist(gen); });
+  return v;
+}
+
+void BM_accumulate(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), 0.0));
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_parAccumulate(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(par::accumulate(ThreadPool::shared(), v, 0.0));
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_inclusiveScan(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  std::vector<double> out(v.size());
+  for (auto _ : state) {
+    std::inclusive_scan(v.begin(), v.end(), out.begin());
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_parInclusiveScan(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  std::vector<double> out(v.size());
+  for (auto _ : state) {
+    par::inclusive_scan(ThreadPool::shared(), v, out.begin());
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_sort(benchmark::State &state) {
+  const auto input = randomDoubles(state);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto v = input;
+    state.ResumeTiming();
+    std::sort(v.begin(), v.end());
+    benchmark::DoNotOptimize(v.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_parSort(benchmark::State &state) {
+  const auto input = randomDoubles(state);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto v = input;
+    state.ResumeTiming();
+    par::sort(ThreadPool::shared(), v);
+    benchmark::DoNotOptimize(v.data());
+  }
+  bench::setBytesProcessed(state);
+}
+// The triples with c <= maxC by trial, a loop per side but with each a
+// ending once a^2 + b^2 passes c^2
+auto tripleBounds(int maxC) {
+  return std::tuple(Bounds{1, maxC}, [](int c) { return Bounds{1, c - 1}; },
+                    [](int, int b) { return Bounds{1, b - 1}; });
+}
+Step tripleVisit(std::vector<Triple<int>> &out, int c, int b, int a) {
+  if (a * a + b * b > c * c) {
+    return Step::Break;
+  }
+  if (a * a + b * b == c * c) {
+    out.push_back({a, b, c});
+  }
+  return Step::Next;
+}
+
+void BM_triplesNested(benchmark::State &state) {
+  for (auto _ : state) {
+    std::vector<Triple<int>> triples;
+    nestedSearch(tripleBounds(static_cast<int>(state.range(0))),
+                 [&](int c, int b, int a) {
+                   return tripleVisit(triples, c, b, a);
+                 });
+    benchmark::DoNotOptimize(triples.data());
+  }
+}
+
+void BM_parTriplesNested(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        par::nested_collect<Triple<int>>(
+            ThreadPool::shared(),
+            tripleBounds(static_cast<int>(state.range(0))),
+            [](std::vector<Triple<int>> &out, int c, int b, int a) {
+              return tripleVisit(out, c, b, a);
+            })
+            .data());
+  }
+}
+
+void BM_triplesEuclid(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        pythagoreanTriples(static_cast<int>(state.range(0))).data());
+  }
+}
+} // namespace
+
+BENCHMARK(BM_accumulate)->Apply(bench::inputSizes);
+BENCHMARK(BM_parAccumulate)->Apply(bench::inputSizes)->UseRealTime();
+BENCHMARK(BM_inclusiveScan)->Apply(bench::inputSizes);
+BENCHMARK(BM_parInclusiveScan)->Apply(bench::inputSizes)->UseRealTime();
+BENCHMARK(BM_sort)->Apply(bench::inputSizes);
+BENCHMARK(BM_parSort)->Apply(bench::inputSizes)->UseRealTime();
+BENCHMARK(BM_triplesNested)->Arg(500)->Arg(1000);
+BENCHMARK(BM_parTriplesNested)->Arg(500)->Arg(1000)->UseRealTime();
+BENCHMARK(BM_triplesEuclid)->Arg(1000)->Arg(100000);
@@ -0,0 +1,226 @@
+#include "Parallel.hpp"
+#include "ThreadPool.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+// Sizes around the chunking boundaries of a grain of 16 on four threads
+constexpr std::array sizes = {0U, 1U, 15U, 16U, 31U, 32U, 33U, 1000U, 10007U};
+constexpr std::size_t grain = 16;
+
+std::vector<std::int64_t> randomInts(std::size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<std::int64_t> dist(-1000, 1000);
+  std::vector<std::int64_t> v(n);
+  std::generate(v.begin(), v.end(), [&] { return dist(gen); });
+  return v;
+}
+} // namespace
+
+TEST_CASE("par::accumulate, inner_product and count") {
+  ThreadPool pool(4);
+  for (const std::size_t n : sizes) {
+    const auto v = randomInts(n, 1);
+    const auto w = randomInts(n + 3, 2);
+    CHECK_EQ(par::accumulate(pool, v, std::int64_t{5}, std::plus<>{}, grain),
+             std::accumulate(v.begin(), v.end(), std::int64_t{5}));
+    CHECK_EQ(par::inner_product(pool, v, w, std::int64_t{0}, std::plus<>{},
+                                std::multiplies<>{}, grain),
+             std::inner_product(v.begin(), v.end(), w.begin(), std::int64_t{0}));
+    CHECK_EQ(par::count(pool, v, 7, ranges::identity{}, grain),
+             std::count(v.begin(), v.end(), 7));
+    CHECK_EQ(par::count_if(
+                 pool, v, [](std::int64_t x) { return x > 0; },
+                 ranges::identity{}, grain),
+             std::count_if(v.begin(), v.end(), [](auto x) { return x > 0; }));
+  }
+  SUBCASE("non commutative op keeps the order") {
+    std::vector<std::string> words(100);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      words[i] = std::to_string(i);
+    }
+    CHECK_EQ(par::accumulate(pool, words, std::string(">"), std::plus<>{}, 4),
+             std::accumulate(words.begin(), words.end(), std::string(">")));
+  }
+  SUBCASE("doubles") {
+    const std::vector<double> v(100000, 0.5);
+    CHECK_EQ(par::accumulate(pool, v, 0.0), doctest::Approx(50000.0));
+  }
+}
+
+TEST_CASE("par::sort") {
+  ThreadPool pool(4);
+  InlineExecutor inline_executor;
+  for (const std::size_t n : sizes) {
+    auto v = randomInts(n, 3);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+    auto u = v;
+    par::sort(pool, v, ranges::less{}, ranges::identity{}, grain);
+    CHECK_EQ(v, expected);
+    par::sort(inline_executor, u, ranges::less{}, ranges::identity{}, grain);
+    CHECK_EQ(u, expected);
+  }
+  SUBCASE("comparator and projection") {
+    std::vector<std::pair<int, std::string>> v;
+    for (int i = 0; i < 500; ++i) {
+      v.emplace_back(i % 37, std::to_string(i));
+    }
+    auto expected = v;
+    std::sort(expected.begin(), expected.end(),
+              [](const auto &a, const auto &b) { return a.first > b.first; });
+    par::sort(pool, v, ranges::greater{}, &std::pair<int, std::string>::first,
+              grain);
+    CHECK_UNARY(std::equal(v.begin(), v.end(), expected.begin(),
+                           [](const auto &a, const auto &b) {
+                             return a.first == b.first;
+                           }));
+    CHECK_UNARY(std::is_permutation(
+        v.begin(), v.end(), expected.begin(), expected.end()));
+  }
+}
+
+TEST_CASE("par::partition_copy and partition") {
+  ThreadPool pool(4);
+  const auto even = [](std::int64_t x) { return x % 2 == 0; };
+  for (const std::size_t n : sizes) {
+    const auto v = randomInts(n, 4);
+    std::vector<std::int64_t> evens;
+    std::vector<std::int64_t> odds;
+    std::partition_copy(v.begin(), v.end(), std::back_inserter(evens),
+                        std::back_inserter(odds), even);
+
+    std::vector<std::int64_t> t(n + 1, 0);
+    std::vector<std::int64_t> f(n + 1, 0);
+    const auto [te, fe] = par::partition_copy(pool, v, t.begin(), f.begin(),
+                                              even, ranges::identity{}, grain);
+    CHECK_EQ(static_cast<std::size_t>(te - t.begin()), evens.size());
+    CHECK_EQ(static_cast<std::size_t>(fe - f.begin()), odds.size());
+    CHECK_UNARY(std::equal(evens.begin(), evens.end(), t.begin()));
+    CHECK_UNARY(std::equal(odds.begin(), odds.end(), f.begin()));
+
+    auto p = v;
+    const auto mid = par::partition(pool, p, even, ranges::identity{}, grain);
+    CHECK_EQ(static_cast<std::size_t>(mid - p.begin()), evens.size());
+    evens.insert(evens.end(), odds.begin(), odds.end());
+    CHECK_EQ(p, evens);
+  }
+}
+
+TEST_CASE("par::inclusive_scan and exclusive_scan") {
+  ThreadPool pool(4);
+  for (const std::size_t n : sizes) {
+    const auto v = randomInts(n, 6);
+    std::vector<std::int64_t> inclusive(n);
+    std::vector<std::int64_t> exclusive(n);
+    std::inclusive_scan(v.begin(), v.end(), inclusive.begin());
+    std::exclusive_scan(v.begin(), v.end(), exclusive.begin(),
+                        std::int64_t{5});
+
+    std::vector<std::int64_t> out(n + 1, 0);
+    CHECK_EQ(par::inclusive_scan(pool, v, out.begin(), std::plus<>{}, grain),
+             out.begin() + static_cast<std::ptrdiff_t>(n));
+    CHECK_UNARY(std::equal(inclusive.begin(), inclusive.end(), out.begin()));
+    CHECK_EQ(par::exclusive_scan(pool, v, out.begin(), std::int64_t{5},
+                                 std::plus<>{}, grain),
+             out.begin() + static_cast<std::ptrdiff_t>(n));
+    CHECK_UNARY(std::equal(exclusive.begin(), exclusive.end(), out.begin()));
+
+    auto p = v;
+    par::inclusive_scan(pool, p, p.begin(), std::plus<>{}, grain);
+    CHECK_EQ(p, inclusive);
+    p = v;
+    par::exclusive_scan(pool, p, p.begin(), std::int64_t{5}, std::plus<>{},
+                        grain);
+    CHECK_EQ(p, exclusive);
+  }
+  SUBCASE("other ops and types keep the order") {
+    std::vector<std::string> words(100);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      words[i] = std::to_string(i % 10);
+    }
+    std::vector<std::string> expected(words.size());
+    std::exclusive_scan(words.begin(), words.end(), expected.begin(),
+                        std::string(">"));
+    std::vector<std::string> out(words.size());
+    par::exclusive_scan(pool, words, out.begin(), std::string(">"),
+                        std::plus<>{}, 4);
+    CHECK_EQ(out, expected);
+
+    const std::vector<int> small = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8};
+    std::vector<int> maxima(small.size());
+    par::inclusive_scan(
+        pool, small, maxima.begin(),
+        [](int a, int b) { return std::max(a, b); }, 2);
+    const std::vector<int> expectedMaxima = {3, 3, 4, 4, 5, 9,
+                                             9, 9, 9, 9, 9, 9};
+    CHECK_EQ(maxima, expectedMaxima);
+  }
+  SUBCASE("doubles") {
+    const std::vector<double> v(100000, 0.5);
+    std::vector<double> out(v.size());
+    par::inclusive_scan(pool, v, out.begin());
+    CHECK_EQ(out.front(), doctest::Approx(0.5));
+    CHECK_EQ(out[49999], doctest::Approx(25000.0));
+    CHECK_EQ(out.back(), doctest::Approx(50000.0));
+  }
+}
+
+TEST_CASE("par::nested_search and nested_collect") {
+  ThreadPool pool(4);
+  using T = std::tuple<int, int, int>;
+  // c, then b < c, then a < b while a^2 + b^2 <= c^2
+  const auto bounds = [](int maxC) {
+    return std::tuple(Bounds{1, maxC}, [](int c) { return Bounds{1, c - 1}; },
+                      [](int, int b) { return Bounds{1, b - 1}; });
+  };
+  const auto triple = [](std::vector<T> &out, int c, int b, int a) {
+    if (a * a + b * b > c * c) {
+      return Step::Break;
+    }
+    if (a * a + b * b == c * c) {
+      out.emplace_back(a, b, c);
+    }
+    return Step::Next;
+  };
+  for (const int maxC : {0, 1, 5, 100, 1000}) {
+    std::vector<T> expected;
+    nestedSearch(bounds(maxC), [&](int c, int b, int a) {
+      return triple(expected, c, b, a);
+    });
+    for (const std::size_t g : {std::size_t{1}, grain}) {
+      CHECK_EQ(par::nested_collect<T>(pool, bounds(maxC), triple, g),
+               expected);
+    }
+
+    std::atomic<std::size_t> count{0};
+    CHECK_UNARY(par::nested_search(pool, bounds(maxC), [&](int c, int b,
+                                                           int a) {
+      if (a * a + b * b == c * c) {
+        ++count;
+      }
+    }));
+    CHECK_EQ(count.load(), expected.size());
+  }
+
+  SUBCASE("Stop ends the search on every thread") {
+    std::atomic<std::size_t> visits{0};
+    CHECK_UNARY_FALSE(
+        par::nested_search(pool, bounds(100000), [&](int c, int b, int a) {
+          ++visits;
+          return a * a + b * b == c * c ? Step::Stop : Step::Next;
+        }));
+    CHECK_LT(visits.load(), std::size_t{1} << 30);
+  }
+}
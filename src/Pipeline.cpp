@@ -0,0 +1,380 @@
+#include "Pipeline.hpp"
+
+#include "RingBuffer.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace pipes {
+namespace {
+// A batch and where it came in the source, so the sink can put them back
+// in order
+struct Sequenced {
+  std::uint64_t seq = 0;
+  Batch items;
+};
+
+// The queue out of the source or a stage. Its producers reserve a slot
+// before they make a batch, so a push always has room and nothing waits
+// on a full queue: a stage without room for its output isn't run. Closed
+// once its producers are done.
+class Channel {
+public:
+  Channel(std::size_t capacity, std::size_t producers, std::size_t consumers)
+      : capacity_(std::max<std::size_t>(capacity, 1)) {
+    if (producers == 1 && consumers == 1) {
+      spsc_ = std::make_unique<SpscRing<Sequenced>>(capacity_);
+    } else {
+      mpmc_ = std::make_unique<MpmcRing<Sequenced>>(capacity_);
+    }
+  }
+
+  // A slot for a batch to come, false when the queue is full
+  bool reserve() {
+    for (auto r = reserved_.load(); r < capacity_;) {
+      if (reserved_.compare_exchange_weak(r, r + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void unreserve() { reserved_.fetch_sub(1); }
+  [[nodiscard]] bool hasRoom() const { return reserved_.load() < capacity_; }
+
+  // Into a reserved slot. The ring has at least capacity_ of them and no
+  // more are reserved, so the push succeeds the first time.
+  void push(Sequenced &&b) {
+    while (!(spsc_ ? spsc_->tryPush(std::move(b))
+                   : mpmc_->tryPush(std::move(b)))) {
+    }
+    filled_.fetch_add(1);
+  }
+
+  // Frees the slot of the batch, for the producers to reserve again
+  std::optional<Sequenced> pop() {
+    auto b = spsc_ ? spsc_->tryPop() : mpmc_->tryPop();
+    if (b) {
+      filled_.fetch_sub(1);
+      reserved_.fetch_sub(1);
+    }
+    return b;
+  }
+  [[nodiscard]] bool ready() const { return filled_.load() != 0; }
+
+  void close() { closed_.store(true); }
+  // Closed, and everything pushed before that popped
+  [[nodiscard]] bool drained() const { return closed_.load() && !ready(); }
+
+private:
+  std::size_t capacity_;
+  std::unique_ptr<SpscRing<Sequenced>> spsc_;
+  std::unique_ptr<MpmcRing<Sequenced>> mpmc_;
+  std::atomic<std::size_t> reserved_{0};
+  std::atomic<std::size_t> filled_{0};
+  std::atomic<bool> closed_{false};
+};
+} // namespace
+
+// What a run shares with its tasks. Node 0 is the source, node k the stage
+// k - 1, which reads channels[k - 1]; node k writes channels[k] and the
+// sink reads the last one. A node runs as tasks on the executor, up to its
+// limit at a time, each taking batches until there are none for it or no
+// room for what it makes, and is posted again by the node that makes some.
+// The atomics are all sequentially consistent: a task stops after it found
+// nothing to do, lowers active and checks again, while a producer pushes
+// and then checks active, so one of them sees the other.
+struct Pipeline::Run : std::enable_shared_from_this<Run> {
+  struct Node {
+    std::size_t limit = 1;
+    std::atomic<std::size_t> active{0};
+    std::atomic<bool> closed{false};
+    // The copies of the stage function, one per task running at a time
+    std::vector<StageFn> fs;
+    std::mutex fsMutex;
+  };
+
+  Pipeline &pipeline;
+  Executor &ex;
+  std::size_t batchSize;
+  bool ordered;
+  // How far the source may get ahead of the sink, so that batches held by
+  // the sink for an earlier one that is still being worked on stay bounded
+  std::uint64_t window;
+  std::vector<std::unique_ptr<Node>> nodes;
+  std::vector<std::unique_ptr<Channel>> channels;
+
+  std::atomic<std::uint64_t> seq{0};
+  std::atomic<bool> sourceDone{false};
+  // The next batch the sink takes, in order
+  std::atomic<std::uint64_t> next{0};
+  std::atomic<bool> stop{false};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  // Tasks posted and not yet done
+  std::atomic<std::size_t> running{0};
+  // Bumped whenever the sink may have something to do, it waits on it
+  std::atomic<std::uint64_t> events{0};
+
+  Run(Pipeline &p, Executor &e, const Options &options)
+      : pipeline(p), ex(e),
+        batchSize(std::max<std::size_t>(options.batchSize, 1)),
+        ordered(options.ordered),
+        window(std::max<std::size_t>(options.queueCapacity, 1) *
+               (p.stages_.size() + 1)) {
+    const std::size_t concurrency = std::max<std::size_t>(ex.concurrency(), 1);
+    nodes.push_back(std::make_unique<Node>());
+    for (const auto &stage : p.stages_) {
+      auto node = std::make_unique<Node>();
+      node->limit = std::min(stage.workers, concurrency);
+      node->fs.assign(node->limit, stage.f);
+      nodes.push_back(std::move(node));
+    }
+    for (std::size_t k = 0; k < nodes.size(); ++k) {
+      channels.push_back(std::make_unique<Channel>(
+          options.queueCapacity, nodes[k]->limit,
+          k + 1 < nodes.size() ? nodes[k + 1]->limit : 1));
+    }
+  }
+
+  void notify() {
+    events.fetch_add(1);
+    events.notify_all();
+  }
+
+  void fail() {
+    {
+      const std::lock_guard lock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+    stop.store(true);
+    notify();
+  }
+
+  // Whether node k has a batch to take and room for what it makes
+  bool runnable(std::size_t k) const {
+    if (stop.load() || !channels[k]->hasRoom()) {
+      return false;
+    }
+    if (k == 0) {
+      return !sourceDone.load() &&
+             (!ordered || seq.load() < next.load() + window);
+    }
+    return channels[k - 1]->ready();
+  }
+
+  // Posts a task of node k, if it is runnable and below its limit
+  void schedule(std::size_t k) {
+    Node &node = *nodes[k];
+    if (!runnable(k)) {
+      return;
+    }
+    for (auto a = node.active.load(); a < node.limit;) {
+      if (node.active.compare_exchange_weak(a, a + 1)) {
+        running.fetch_add(1);
+        post(k);
+        return;
+      }
+    }
+  }
+
+  void post(std::size_t k) {
+    try {
+      // The task may outlive run, which returns once running is 0
+      ex.post([run = shared_from_this(), k] { run->work(k); });
+    } catch (...) {
+      fail();
+      nodes[k]->active.fetch_sub(1);
+      running.fetch_sub(1);
+      notify();
+    }
+  }
+
+  void work(std::size_t k) {
+    Node &node = *nodes[k];
+    try {
+      if (k == 0) {
+        produce();
+      } else {
+        StageFn f = takeFn(node);
+        transform(k, f);
+        giveFn(node, std::move(f));
+      }
+    } catch (...) {
+      fail();
+    }
+    node.active.fetch_sub(1);
+    if (finished(k)) {
+      close(k);
+    } else {
+      schedule(k);
+    }
+    running.fetch_sub(1);
+    notify();
+  }
+
+  void produce() {
+    Channel &out = *channels[0];
+    while (!stop.load() && (!ordered || seq.load() < next.load() + window) &&
+           out.reserve()) {
+      Sequenced b{seq.load(), {}};
+      b.items.reserve(batchSize);
+      if (!pipeline.source_(b.items, batchSize)) {
+        out.unreserve();
+        sourceDone.store(true);
+        return;
+      }
+      seq.store(b.seq + 1);
+      out.push(std::move(b));
+      after(0);
+    }
+  }
+
+  void transform(std::size_t k, StageFn &f) {
+    Channel &in = *channels[k - 1];
+    Channel &out = *channels[k];
+    while (!stop.load() && out.reserve()) {
+      auto b = in.pop();
+      if (!b) {
+        out.unreserve();
+        return;
+      }
+      // There is room in the queue into this stage again
+      schedule(k - 1);
+      // Empty batches go on too, the sink counts them off
+      Sequenced result{b->seq, {}};
+      result.items.reserve(b->items.size());
+      f(b->items, result.items);
+      out.push(std::move(result));
+      after(k);
+    }
+  }
+
+  // Node k pushed a batch, for the node after it or the sink
+  void after(std::size_t k) {
+    if (k + 1 < nodes.size()) {
+      schedule(k + 1);
+    } else {
+      notify();
+    }
+  }
+
+  bool finished(std::size_t k) const {
+    return k == 0 ? sourceDone.load() : channels[k - 1]->drained();
+  }
+
+  // Closes the output of node k once it is finished and none of its tasks
+  // runs any more, which the last of them to stop or the node closing its
+  // input sees
+  void close(std::size_t k) {
+    if (!finished(k) || nodes[k]->active.load() != 0 ||
+        nodes[k]->closed.exchange(true)) {
+      return;
+    }
+    channels[k]->close();
+    if (k + 1 < nodes.size()) {
+      close(k + 1);
+    } else {
+      notify();
+    }
+  }
+
+  static StageFn takeFn(Node &node) {
+    const std::lock_guard lock(node.fsMutex);
+    StageFn f = std::move(node.fs.back());
+    node.fs.pop_back();
+    return f;
+  }
+  static void giveFn(Node &node, StageFn f) {
+    const std::lock_guard lock(node.fsMutex);
+    node.fs.push_back(std::move(f));
+  }
+
+  // Runs sink on the calling thread until the last batch, helping with the
+  // tasks of the executor or sleeping while there is nothing for it
+  void drain(const Sink &sink) {
+    Channel &in = *channels.back();
+    // Batches that came before their turn
+    std::map<std::uint64_t, Batch> early;
+    const auto consume = [&](const Batch &b) {
+      if (!b.empty()) {
+        sink(b);
+      }
+    };
+    schedule(0);
+    for (;;) {
+      const auto e = events.load();
+      if (stop.load()) {
+        return;
+      }
+      const bool closed = in.drained();
+      if (auto b = in.pop()) {
+        schedule(nodes.size() - 1);
+        if (!ordered) {
+          consume(b->items);
+          continue;
+        }
+        if (b->seq != next.load()) {
+          early.emplace(b->seq, std::move(b->items));
+          continue;
+        }
+        consume(b->items);
+        auto n = next.load() + 1;
+        for (; !early.empty() && early.begin()->first == n; ++n) {
+          consume(early.begin()->second);
+          early.erase(early.begin());
+        }
+        next.store(n);
+        // The source may be waiting for the sink to catch up
+        schedule(0);
+        continue;
+      }
+      if (closed) {
+        return;
+      }
+      if (!ex.tryRunOne()) {
+        events.wait(e);
+      }
+    }
+  }
+
+  // Returns once no task is left, they use the stages of the pipeline
+  void join() {
+    for (auto e = events.load(); running.load() != 0; e = events.load()) {
+      if (!ex.tryRunOne()) {
+        events.wait(e);
+      }
+    }
+  }
+};
+
+Pipeline &Pipeline::then(StageFn f, std::size_t workers) {
+  stages_.push_back({std::move(f), std::max<std::size_t>(workers, 1)});
+  return *this;
+}
+
+void Pipeline::run(const Sink &sink, const Options &options) {
+  Executor &ex =
+      options.executor != nullptr ? *options.executor : ThreadPool::shared();
+  const auto run = std::make_shared<Run>(*this, ex, options);
+  try {
+    run->drain(sink);
+  } catch (...) {
+    run->fail();
+  }
+  run->join();
+  if (run->error) {
+    std::rethrow_exception(run->error);
+  }
+}
+
+} // namespace pipes
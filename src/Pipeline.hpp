@@ -0,0 +1,212 @@
+#pragma once
+
+#include "Executor.hpp"
+
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/traits.hpp>
+#include <range/v3/view/all.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A pipeline of std::string_view stages running concurrently on an
+// Executor, for CPU bound stages that one thread would run one after the
+// other, e.g.
+//   splitLines(s) |
+//       pipes::transform([](std::string_view l) { return trim(l); }) |
+//       pipes::for_each(split_sv(' '), 2) |
+//       pipes::sink([&](std::string_view w) { ++counts[w]; });
+// The stages pass batches of elements through bounded lock free queues, a
+// SpscRing between single workers and an MpmcRing where a stage has more.
+// A stage runs as tasks that return when it has nothing to take or no room
+// for what it makes, and are posted again once it has, so a slow stage
+// holds back the ones before it instead of the pipeline buffering without
+// end, and nothing spins or holds a thread while it waits.
+namespace pipes {
+
+using Batch = std::vector<std::string_view>;
+
+struct Options {
+  // Elements per batch, what a stage gets at a time
+  std::size_t batchSize = 1024;
+  // Batches a queue between two stages holds before its producers stop
+  std::size_t queueCapacity = 16;
+  // Whether the sink gets the elements in the order of the source, or in
+  // the order the stages get done with them. In order, the source gets at
+  // most queueCapacity batches per queue ahead of the sink, so a batch a
+  // stage is slow on holds back the rest instead of them piling up.
+  bool ordered = true;
+  // Where the stages run, ThreadPool::shared() if null
+  Executor *executor = nullptr;
+};
+
+class Pipeline {
+public:
+  // Appends up to n elements to batch, false once there are none left
+  using Source = std::function<bool(Batch &batch, std::size_t n)>;
+  // Appends what the elements of in become to out
+  using StageFn =
+      std::function<void(std::span<const std::string_view> in, Batch &out)>;
+  using Sink = std::function<void(std::span<const std::string_view>)>;
+
+  explicit Pipeline(Source source) : source_(std::move(source)) {}
+
+  // Adds a stage after the others, up to workers tasks of it run at the same
+  // time, at most the concurrency of the executor, each calling a copy of f
+  // of its own
+  Pipeline &then(StageFn f, std::size_t workers = 1);
+
+  // Runs the source and the stages on the executor and sink on the calling
+  // thread, batch by batch, and returns once sink got everything. While
+  // there is nothing for sink, the calling thread runs tasks of the executor
+  // or sleeps. The first exception of the source, a stage or sink stops them
+  // all, and is rethrown once none of their tasks runs any more. Runs once,
+  // it uses up the source.
+  void run(const Sink &sink, const Options &options = {});
+
+private:
+  struct Run;
+  struct Stage {
+    StageFn f;
+    std::size_t workers;
+  };
+
+  Source source_;
+  std::vector<Stage> stages_;
+};
+
+namespace detail {
+template <typename R>
+concept stringViewRange =
+    ranges::input_range<R> &&
+    std::convertible_to<ranges::range_reference_t<R>, std::string_view>;
+
+// An rvalue container is moved into the pipeline, anything else viewed
+template <typename R>
+using Held =
+    std::conditional_t<std::is_lvalue_reference_v<R> ||
+                           ranges::view_<std::remove_cvref_t<R>>,
+                       ranges::views::all_t<R>, std::remove_cvref_t<R>>;
+
+template <stringViewRange R> Pipeline::Source sourceOf(R &&rng) {
+  struct State {
+    Held<R> rng;
+    std::optional<ranges::iterator_t<Held<R>>> it;
+  };
+  auto state = [&] {
+    if constexpr (std::is_same_v<Held<R>, std::remove_cvref_t<R>>) {
+      return std::make_shared<State>(State{std::forward<R>(rng), {}});
+    } else {
+      return std::make_shared<State>(
+          State{ranges::views::all(std::forward<R>(rng)), {}});
+    }
+  }();
+  return [state](Batch &batch, std::size_t n) {
+    auto &[r, it] = *state;
+    if (!it) {
+      it = ranges::begin(r);
+    }
+    for (; batch.size() < n && *it != ranges::end(r); ++*it) {
+      batch.emplace_back(**it);
+    }
+    return !batch.empty();
+  };
+}
+
+struct StageClosure {
+  Pipeline::StageFn f;
+  std::size_t workers;
+
+  friend Pipeline operator|(Pipeline p, const StageClosure &s) {
+    p.then(s.f, s.workers);
+    return p;
+  }
+  template <stringViewRange R>
+  friend Pipeline operator|(R &&rng, const StageClosure &s) {
+    return Pipeline(sourceOf(std::forward<R>(rng))) | s;
+  }
+};
+
+struct SinkClosure {
+  Pipeline::Sink sink;
+  Options options;
+
+  friend void operator|(Pipeline p, const SinkClosure &s) {
+    p.run(s.sink, s.options);
+  }
+  template <stringViewRange R>
+  friend void operator|(R &&rng, const SinkClosure &s) {
+    Pipeline(sourceOf(std::forward<R>(rng))) | s;
+  }
+};
+} // namespace detail
+
+// f(x) for every element x, f returns something convertible to a
+// std::string_view into memory that outlives the pipeline
+template <typename F>
+[[nodiscard]] detail::StageClosure transform(F f, std::size_t workers = 1) {
+  using R = std::invoke_result_t<F &, std::string_view>;
+  static_assert(std::is_lvalue_reference_v<R> ||
+                    !std::is_same_v<std::remove_cvref_t<R>, std::string>,
+                "pipes::transform: f returns a std::string, which is gone "
+                "before the std::string_view of it reaches the next stage");
+  return {[f = std::move(f)](std::span<const std::string_view> in,
+                             Batch &out) mutable {
+            for (const std::string_view x : in) {
+              out.emplace_back(std::invoke(f, x));
+            }
+          },
+          workers};
+}
+
+// The elements x with pred(x)
+template <typename Pred>
+[[nodiscard]] detail::StageClosure filter(Pred pred, std::size_t workers = 1) {
+  return {[pred = std::move(pred)](std::span<const std::string_view> in,
+                                   Batch &out) mutable {
+            for (const std::string_view x : in) {
+              if (std::invoke(pred, x)) {
+                out.push_back(x);
+              }
+            }
+          },
+          workers};
+}
+
+// The elements of the ranges f(x), flattened, as rv::for_each
+template <typename F>
+[[nodiscard]] detail::StageClosure for_each(F f, std::size_t workers = 1) {
+  return {[f = std::move(f)](std::span<const std::string_view> in,
+                             Batch &out) mutable {
+            for (const std::string_view x : in) {
+              for (auto &&y : std::invoke(f, x)) {
+                out.emplace_back(y);
+              }
+            }
+          },
+          workers};
+}
+
+// Runs the pipeline, f(x) for every element that comes out of it, on the
+// calling thread
+template <typename F>
+[[nodiscard]] detail::SinkClosure sink(F f, const Options &options = {}) {
+  return {[f = std::move(f)](std::span<const std::string_view> batch) mutable {
+            for (const std::string_view x : batch) {
+              std::invoke(f, x);
+            }
+          },
+          options};
+}
+
+} // namespace pipes
@@ -0,0 +1,165 @@
+#include "Pipeline.hpp"
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+std::string makeLog(int lines) {
+  std::string s;
+  for (int i = 0; i < lines; ++i) {
+    s += "  line " + std::to_string(i) + " word" + std::to_string(i % 7) +
+         (i % 3 == 0 ? "   \n" : "\n");
+  }
+  return s;
+}
+
+bool isWord(std::string_view w) { return w.starts_with("word"); }
+} // namespace
+
+TEST_CASE("pipes") {
+  const std::string log = makeLog(5000);
+  std::vector<std::string_view> serial;
+  for (const auto line : splitLines(log)) {
+    for (const auto w : split_sv(trim(line), ' ')) {
+      serial.push_back(w);
+    }
+  }
+
+  ThreadPool pool(4);
+  SUBCASE("ordered, with several workers per stage") {
+    std::vector<std::string_view> out;
+    pipes::Options options;
+    options.executor = &pool;
+    options.batchSize = 64;
+    options.queueCapacity = 4;
+    splitLines(log) |
+        pipes::transform([](std::string_view s) { return trim(s); }, 3) |
+        pipes::for_each(split_sv(' '), 2) |
+        pipes::sink([&](std::string_view w) { out.push_back(w); }, options);
+    CHECK_EQ(out, serial);
+  }
+
+  SUBCASE("unordered, the same elements") {
+    std::map<std::string_view, int> counts;
+    std::map<std::string_view, int> expected;
+    for (const auto w : serial) {
+      expected[w] += isWord(w) ? 1 : 0;
+    }
+    std::erase_if(expected, [](const auto &kv) { return kv.second == 0; });
+    pipes::Options options;
+    options.batchSize = 100;
+    options.ordered = false;
+    options.executor = &pool;
+    const auto lines = splitLines(log);
+    lines | pipes::transform([](std::string_view s) { return trim(s); }) |
+        pipes::for_each(split_sv(' '), 4) | pipes::filter(isWord, 2) |
+        pipes::sink([&](std::string_view w) { ++counts[w]; }, options);
+    CHECK_EQ(counts, expected);
+  }
+
+  SUBCASE("batches and queues of one") {
+    std::vector<std::string_view> out;
+    pipes::Options options;
+    options.batchSize = 1;
+    options.queueCapacity = 1;
+    splitLines(log) | pipes::for_each(split_sv(' '), 2) |
+        pipes::filter([](std::string_view w) { return !w.empty(); }) |
+        pipes::sink([&](std::string_view w) { out.push_back(w); }, options);
+    CHECK_EQ(out, serial);
+  }
+
+  SUBCASE("a slow batch holds back the source") {
+    pipes::Options options;
+    options.batchSize = 1;
+    options.queueCapacity = 2;
+    options.executor = &pool;
+    std::size_t pos = 0;
+    std::atomic<std::size_t> produced{0};
+    std::size_t producedWhileSlow = 0;
+    pipes::Pipeline p([&](pipes::Batch &batch, std::size_t n) {
+      for (; batch.size() < n && pos < serial.size(); ++pos) {
+        batch.push_back(serial[pos]);
+      }
+      produced += batch.empty() ? 0 : 1;
+      return !batch.empty();
+    });
+    p.then(
+        [&](std::span<const std::string_view> in, pipes::Batch &out) {
+          if (in.front().data() == serial.front().data()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            producedWhileSlow = produced.load();
+          }
+          out.assign(in.begin(), in.end());
+        },
+        4);
+    std::vector<std::string_view> out;
+    p.run(
+        [&](std::span<const std::string_view> b) {
+          out.insert(out.end(), b.begin(), b.end());
+        },
+        options);
+    CHECK_EQ(out, serial);
+    // queueCapacity batches for each of the two queues, none held in between
+    CHECK_LE(producedWhileSlow, 4U);
+  }
+
+  SUBCASE("on the calling thread alone") {
+    InlineExecutor inlineExecutor;
+    pipes::Options options;
+    options.batchSize = 10;
+    options.queueCapacity = 1;
+    options.executor = &inlineExecutor;
+    std::vector<std::string_view> out;
+    splitLines(log) |
+        pipes::transform([](std::string_view s) { return trim(s); }, 3) |
+        pipes::for_each(split_sv(' '), 2) |
+        pipes::sink([&](std::string_view w) { out.push_back(w); }, options);
+    CHECK_EQ(out, serial);
+  }
+
+  SUBCASE("no stages and no elements") {
+    std::vector<std::string_view> out;
+    serial | pipes::sink([&](std::string_view w) { out.push_back(w); });
+    CHECK_EQ(out, serial);
+    const std::vector<std::string_view> none;
+    std::size_t seen = 0;
+    none | pipes::transform([](std::string_view s) { return s; }, 2) |
+        pipes::sink([&](std::string_view) { ++seen; });
+    CHECK_EQ(seen, 0U);
+  }
+
+  SUBCASE("the first exception is rethrown") {
+    const auto throwAt = [](std::string_view w) {
+      if (w == "4321") {
+        throw std::runtime_error("stage");
+      }
+      return w;
+    };
+    CHECK_THROWS_AS(
+        log | split_sv(' ') | pipes::transform(throwAt, 2) |
+            pipes::sink([](std::string_view) {}),
+        std::runtime_error);
+    std::size_t seen = 0;
+    const auto same = [](std::string_view w) { return w; };
+    CHECK_THROWS_AS(serial | pipes::transform(same, 2) |
+                        pipes::sink([&](std::string_view) {
+                          if (++seen == 100) {
+                            throw std::logic_error("sink");
+                          }
+                        }),
+                    std::logic_error);
+  }
+}
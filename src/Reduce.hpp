@@ -0,0 +1,182 @@
+#pragma once
+
+#include "Simd.hpp"
+
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// How the floating point overloads of simd_reduce and simd_transform_reduce
+// add. All of them reassociate, Kahan and Pairwise keep the rounding error
+// from growing with the number of values.
+enum class Summation { Plain, Kahan, Pairwise };
+
+namespace detail {
+inline constexpr std::size_t reduceLanes = 8;
+inline constexpr std::size_t pairwiseLeaf = 1024;
+
+// init op f(p[0]) op f(p[1]) ..., reordered into reduceLanes independent
+// accumulators, which the compiler keeps in vector registers, folded as a
+// tree at the end
+template <typename T, typename P, typename Op, typename F>
+T laneReduce(const P *p, std::size_t n, T init, Op &op, F &f) {
+  constexpr std::size_t lanes = reduceLanes;
+  std::size_t i = 0;
+  if (n >= lanes) {
+    auto acc = [&]<std::size_t... J>(std::index_sequence<J...>) {
+      return std::array<T, lanes>{T(std::invoke(f, p[J]))...};
+    }(std::make_index_sequence<lanes>{});
+    for (i = lanes; i + lanes <= n; i += lanes) {
+#pragma GCC unroll 8
+      for (std::size_t j = 0; j < lanes; ++j) {
+        acc[j] = std::invoke(op, std::move(acc[j]), std::invoke(f, p[i + j]));
+      }
+    }
+    for (std::size_t w = lanes / 2; w != 0; w /= 2) {
+      for (std::size_t j = 0; j < w; ++j) {
+        acc[j] = std::invoke(op, std::move(acc[j]), std::move(acc[j + w]));
+      }
+    }
+    init = std::invoke(op, std::move(init), std::move(acc[0]));
+  }
+  for (; i < n; ++i) {
+    init = std::invoke(op, std::move(init), std::invoke(f, p[i]));
+  }
+  return init;
+}
+
+// Sum of f(p[i]) with a Kahan summation in each of reduceLanes lanes, and
+// one more to fold them
+template <typename T, typename P, typename F>
+T kahanLanes(const P *p, std::size_t n, F &f) {
+  constexpr std::size_t lanes = reduceLanes;
+  std::array<T, lanes> s{};
+  std::array<T, lanes> c{};
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+#pragma GCC unroll 8
+    for (std::size_t j = 0; j < lanes; ++j) {
+      const T y = T(std::invoke(f, p[i + j])) - c[j];
+      const T t = s[j] + y;
+      c[j] = (t - s[j]) - y;
+      s[j] = t;
+    }
+  }
+  T total = 0;
+  T error = 0;
+  const auto add = [&](T x) {
+    const T y = x - error;
+    const T t = total + y;
+    error = (t - total) - y;
+    total = t;
+  };
+  for (std::size_t j = 0; j < lanes; ++j) {
+    add(s[j]);
+    add(-c[j]);
+  }
+  for (; i < n; ++i) {
+    add(T(std::invoke(f, p[i])));
+  }
+  return total;
+}
+
+// leaf(p, n) summed over halves of halves, so every value goes through
+// O(log n) additions
+template <typename T, typename P, typename Leaf>
+T pairwise(const P *p, std::size_t n, Leaf &leaf) {
+  if (n <= pairwiseLeaf) {
+    return leaf(p, n);
+  }
+  const std::size_t half = n / 2;
+  return pairwise<T>(p, half, leaf) + pairwise<T>(p + half, n - half, leaf);
+}
+
+// The sum of f(p[i]) the floating point overloads share. Sums of the float
+// or double values themselves run on the simd::sum kernels.
+template <typename T, typename P, typename F>
+T floatSum(const P *p, std::size_t n, T init, F &f, Summation summation) {
+  const auto leaf = [&](const P *q, std::size_t m) -> T {
+    if constexpr (std::is_same_v<std::remove_cv_t<P>, T> &&
+                  std::is_same_v<F, std::identity> &&
+                  (std::is_same_v<T, double> || std::is_same_v<T, float>)) {
+      return simd::sum(q, m, summation == Summation::Kahan);
+    } else {
+      if (summation == Summation::Kahan) {
+        return kahanLanes<T>(q, m, f);
+      }
+      std::plus<> plus;
+      return laneReduce(q, m, T{0}, plus, f);
+    }
+  };
+  return init + (summation == Summation::Pairwise ? pairwise<T>(p, n, leaf)
+                                                  : leaf(p, n));
+}
+
+template <typename Op, typename T>
+inline constexpr bool isFloatPlus =
+    std::floating_point<T> &&
+    (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>>);
+} // namespace detail
+
+// rg::accumulate over a contiguous range, but like std::reduce op must be
+// associative and commutative: lane j folds the elements j, j + 8, ..., see
+// detail::laneReduce. A float or double sum runs on the simd::sum kernels.
+// Either way a floating point result may differ from the sequential one in
+// the last bits.
+template <typename R, typename T, typename Op = std::plus<>>
+  requires ranges::contiguous_range<R> && ranges::sized_range<R> &&
+           (!std::same_as<Op, Summation>)
+T simd_reduce(R &&rng, T init, Op op = {}) {
+  const auto *p = ranges::data(rng);
+  const auto n = static_cast<std::size_t>(ranges::size(rng));
+  std::identity f;
+  if constexpr (detail::isFloatPlus<Op, T>) {
+    return detail::floatSum(p, n, init, f, Summation::Plain);
+  } else {
+    return detail::laneReduce(p, n, std::move(init), op, f);
+  }
+}
+
+// simd_reduce(rng, init, reduce) of transform(x) for every x, in one pass
+template <typename R, typename T, typename Reduce, typename Transform>
+  requires ranges::contiguous_range<R> && ranges::sized_range<R> &&
+           (!std::same_as<Transform, Summation>)
+T simd_transform_reduce(R &&rng, T init, Reduce reduce, Transform transform) {
+  const auto *p = ranges::data(rng);
+  const auto n = static_cast<std::size_t>(ranges::size(rng));
+  if constexpr (detail::isFloatPlus<Reduce, T>) {
+    return detail::floatSum(p, n, init, transform, Summation::Plain);
+  } else {
+    return detail::laneReduce(p, n, std::move(init), reduce, transform);
+  }
+}
+
+// The floating point sum of rng, added as summation says
+template <typename R, std::floating_point T>
+  requires ranges::contiguous_range<R> && ranges::sized_range<R>
+T simd_reduce(R &&rng, T init, Summation summation) {
+  std::identity f;
+  return detail::floatSum(ranges::data(rng),
+                          static_cast<std::size_t>(ranges::size(rng)), init, f,
+                          summation);
+}
+
+// The floating point sum of transform(x) for every x, added as summation
+// says. E.g. the conductance of resistors in parallel,
+// simd_transform_reduce(r, 0.0, [](int x) { return 1.0 / x; },
+//                       Summation::Kahan)
+template <typename R, std::floating_point T, typename Transform>
+  requires ranges::contiguous_range<R> && ranges::sized_range<R>
+T simd_transform_reduce(R &&rng, T init, Transform transform,
+                        Summation summation) {
+  return detail::floatSum(ranges::data(rng),
+                          static_cast<std::size_t>(ranges::size(rng)), init,
+                          transform, summation);
+}
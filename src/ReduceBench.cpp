@@ -0,0 +1,108 @@
+#include "Bench.hpp"
+#include "Reduce.hpp"
+#include "Sliding.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<double> randomDoubles(const benchmark::State &state) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(1, 100);
+  std::vector<double> v(bench::inputSize(state) / sizeof(double));
+  for (auto &x : v) {
+    x = dist(gen);
+  }
+  return v;
+}
+
+// One dependency chain through every add, the baseline simd_reduce splits
+void BM_accumulateChain(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), 0.0));
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_simdReduce(benchmark::State &state, Summation summation) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(simd_reduce(v, 0.0, summation));
+  }
+  bench::setBytesProcessed(state);
+}
+
+// The resistors in parallel fold, sum of 1 / x
+void BM_accumulateInverse(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(
+        v.begin(), v.end(), 0.0, [](double a, double x) { return a + 1.0 / x; }));
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_simdTransformReduceInverse(benchmark::State &state,
+                                   Summation summation) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(simd_transform_reduce(
+        v, 0.0, [](double x) { return 1.0 / x; }, summation));
+  }
+  bench::setBytesProcessed(state);
+}
+
+constexpr std::size_t slidingWindow = 64;
+
+// Every window summed and searched over again, what sliding(k) and a fold
+// of every window cost
+void BM_slidingRecomputed(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  const std::size_t k = slidingWindow;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i + k <= v.size(); ++i) {
+      const auto *first = v.data() + i;
+      benchmark::DoNotOptimize(std::accumulate(first, first + k, 0.0));
+      benchmark::DoNotOptimize(*std::max_element(first, first + k));
+    }
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_slidingIncremental(benchmark::State &state) {
+  const auto v = randomDoubles(state);
+  for (auto _ : state) {
+    for (const double x : v | sliding_sum(slidingWindow)) {
+      benchmark::DoNotOptimize(x);
+    }
+    for (const double x : v | sliding_max(slidingWindow)) {
+      benchmark::DoNotOptimize(x);
+    }
+  }
+  bench::setBytesProcessed(state);
+}
+} // namespace
+
+BENCHMARK(BM_accumulateChain)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_simdReduce, plain, Summation::Plain)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_simdReduce, kahan, Summation::Kahan)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_simdReduce, pairwise, Summation::Pairwise)
+    ->Apply(bench::inputSizes);
+BENCHMARK(BM_accumulateInverse)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_simdTransformReduceInverse, plain, Summation::Plain)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_simdTransformReduceInverse, kahan, Summation::Kahan)
+    ->Apply(bench::inputSizes);
+BENCHMARK(BM_slidingRecomputed)
+    ->RangeMultiplier(32)
+    ->Range(std::int64_t{1} << 10, std::int64_t{1} << 25);
+BENCHMARK(BM_slidingIncremental)->Apply(bench::inputSizes);
@@ -0,0 +1,106 @@
+#include "Reduce.hpp"
+#include "SimdTestSupport.hpp"
+
+#include <doctest/doctest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace {
+template <typename T> long double exactSum(const std::vector<T> &v) {
+  return std::accumulate(v.begin(), v.end(), 0.0L);
+}
+} // namespace
+
+TEST_CASE("simd_reduce") {
+  SUBCASE("integers, every length around the lanes") {
+    for (std::size_t n = 0; n < 40; ++n) {
+      std::vector<std::int64_t> v(n);
+      std::iota(v.begin(), v.end(), -5);
+      CHECK_EQ(simd_reduce(v, std::int64_t{3}),
+               std::accumulate(v.begin(), v.end(), std::int64_t{3}));
+      CHECK_EQ(simd_reduce(v, std::int64_t{0}, [](auto a, auto b) {
+                 return std::max(a, b);
+               }),
+               n == 0 ? 0 : std::max<std::int64_t>(0, v.back()));
+    }
+  }
+  SUBCASE("accumulate, foldl") {
+    const std::vector v = {1.5, 2.7, 3.8, 4.2};
+    CHECK_EQ(simd_reduce(v, .0), doctest::Approx(12.2));
+    const std::vector m = {1, 2, 3, 4};
+    CHECK_EQ(simd_reduce(m, 1, std::multiplies<>()), 24);
+  }
+}
+
+TEST_CASE("simd_reduce of floating point") {
+  std::vector<double> d(1000003, 0.1);
+  std::vector<float> f(1000003, 0.1F);
+  const auto exactD = exactSum(d);
+  const auto exactF = exactSum(f);
+  forEachIsa([&](simd::Isa) {
+    for (const auto s : {Summation::Plain, Summation::Kahan,
+                         Summation::Pairwise}) {
+      CHECK_EQ(simd_reduce(d, 1.0, s),
+               doctest::Approx(static_cast<double>(exactD + 1)));
+    }
+    const auto err = [](long double x, long double exact) {
+      return std::fabs(static_cast<double>(x - exact));
+    };
+    // Plain float sums of a million values are off in the fourth digit
+    const double plain = err(simd_reduce(f, 0.0F), exactF);
+    const double kahan = err(simd_reduce(f, 0.0F, Summation::Kahan), exactF);
+    const double pairwise =
+        err(simd_reduce(f, 0.0F, Summation::Pairwise), exactF);
+    CHECK_LE(kahan, 0.02);
+    CHECK_LE(kahan * 10, plain);
+    CHECK_LE(pairwise * 10, plain);
+    for (std::size_t n = 0; n < 70; ++n) {
+      const std::vector<double> v(n, 0.5);
+      const doctest::Approx expected(0.5 * static_cast<double>(n));
+      CHECK_EQ(simd_reduce(v, 0.0), expected);
+      CHECK_EQ(simd_reduce(v, 0.0, Summation::Kahan), expected);
+    }
+  });
+  SUBCASE("no cancellation loss with Kahan") {
+    std::vector<double> v(1000, 1e-16);
+    v.front() = 1.0;
+    CHECK_EQ(simd_reduce(v, 0.0, Summation::Kahan),
+             doctest::Approx(1.0 + 999e-16).epsilon(1e-15));
+  }
+}
+
+TEST_CASE("simd_transform_reduce") {
+  SUBCASE("Resistors in parallel, 1/R = 1/R1 + 1/R2 + 1/R3") {
+    const std::vector v = {20, 10, 15};
+    const auto inv = [](int x) { return 1.0 / x; };
+    CHECK_EQ(1.0 / simd_transform_reduce(v, 0.0, std::plus<>(), inv),
+             doctest::Approx(4.61538));
+    for (const auto s : {Summation::Plain, Summation::Kahan,
+                         Summation::Pairwise}) {
+      CHECK_EQ(1.0 / simd_transform_reduce(v, 0.0, inv, s),
+               doctest::Approx(4.61538));
+    }
+  }
+  SUBCASE("long inputs") {
+    std::vector<int> v(100000);
+    std::iota(v.begin(), v.end(), 1);
+    const auto square = [](int x) { return std::int64_t{x} * x; };
+    std::int64_t expected = 0;
+    for (const int x : v) {
+      expected += square(x);
+    }
+    CHECK_EQ(simd_transform_reduce(v, std::int64_t{0}, std::plus<>(), square),
+             expected);
+    const auto inv = [](int x) { return 1.0 / x; };
+    long double harmonic = 0;
+    for (const int x : v) {
+      harmonic += 1.0L / x;
+    }
+    CHECK_EQ(simd_transform_reduce(v, 0.0, inv, Summation::Kahan),
+             doctest::Approx(static_cast<double>(harmonic)).epsilon(1e-15));
+  }
+}
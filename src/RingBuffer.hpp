@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Bounded lock free queues of a power of two slots, at least 2. Neither
+// blocks: tryPush fails when the ring is full, which is the backpressure a
+// producer waits on, tryPop when it is empty. tryPush moves from x only
+// when it succeeds, so a failed push can be retried with the same x.
+
+// One producer thread and one consumer thread. Each side caches the index
+// of the other, so it only touches the other's cache line when the ring
+// looks full or empty.
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+        slots_(mask_ + 1) {}
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+  SpscRing(SpscRing &&) = delete;
+  SpscRing &operator=(SpscRing &&) = delete;
+  ~SpscRing() = default;
+
+  // Producer only
+  bool tryPush(T &&x) {
+    const std::size_t t = tail_.load(std::memory_order_relaxed);
+    if (t - headCache_ > mask_) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (t - headCache_ > mask_) {
+        return false;
+      }
+    }
+    slots_[t & mask_] = std::move(x);
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  std::optional<T> tryPop() {
+    const std::size_t h = head_.load(std::memory_order_relaxed);
+    if (h == tailCache_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (h == tailCache_) {
+        return std::nullopt;
+      }
+    }
+    std::optional<T> x(std::move(slots_[h & mask_]));
+    head_.store(h + 1, std::memory_order_release);
+    return x;
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+  // The consumer's line
+  alignas(64) std::atomic<std::size_t> head_{0};
+  std::size_t tailCache_ = 0;
+  // The producer's line
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  std::size_t headCache_ = 0;
+  alignas(64) std::size_t mask_;
+  std::vector<T> slots_;
+};
+
+// Any number of producers and consumers, Vyukov's bounded MPMC queue:
+// every slot has a sequence number that says whose turn it is, pos for the
+// producer of position pos, pos + 1 for its consumer, so a thread claims a
+// position with one CAS and never waits on another one in the middle of
+// its push or pop.
+template <typename T> class MpmcRing {
+public:
+  explicit MpmcRing(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+        slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  MpmcRing(const MpmcRing &) = delete;
+  MpmcRing &operator=(const MpmcRing &) = delete;
+  MpmcRing(MpmcRing &&) = delete;
+  MpmcRing &operator=(MpmcRing &&) = delete;
+  ~MpmcRing() = default;
+
+  bool tryPush(T &&x) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &s = slots_[pos & mask_];
+      const std::size_t seq = s.seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq - pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          s.value = std::move(x);
+          s.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The slot still holds what was pushed a lap ago
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> tryPop() {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &s = slots_[pos & mask_];
+      const std::size_t seq = s.seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          std::optional<T> x(std::move(s.value));
+          s.seq.store(pos + mask_ + 1, std::memory_order_release);
+          return x;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+  struct alignas(64) Slot {
+    std::atomic<std::size_t> seq;
+    T value;
+  };
+
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  alignas(64) std::size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+};
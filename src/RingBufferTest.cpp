@@ -0,0 +1,103 @@
+#include "RingBuffer.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SpscRing") {
+  SUBCASE("fifo, full and empty") {
+    SpscRing<std::string> ring(3);
+    CHECK_EQ(ring.capacity(), 4U);
+    CHECK_UNARY_FALSE(ring.tryPop().has_value());
+    for (const char *s : {"a", "b", "c", "d"}) {
+      CHECK_UNARY(ring.tryPush(s));
+    }
+    std::string e = "e";
+    CHECK_UNARY_FALSE(ring.tryPush(std::move(e)));
+    CHECK_EQ(e, "e");
+    CHECK_EQ(ring.tryPop(), "a");
+    CHECK_UNARY(ring.tryPush(std::move(e)));
+    for (const char *s : {"b", "c", "d", "e"}) {
+      CHECK_EQ(ring.tryPop(), s);
+    }
+    CHECK_UNARY_FALSE(ring.tryPop().has_value());
+  }
+
+  SUBCASE("across two threads") {
+    constexpr int n = 100000;
+    SpscRing<int> ring(8);
+    std::thread producer([&] {
+      for (int i = 0; i < n; ++i) {
+        while (!ring.tryPush(int{i})) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    bool inOrder = true;
+    for (int i = 0; i < n;) {
+      if (const auto x = ring.tryPop()) {
+        inOrder = inOrder && *x == i;
+        ++i;
+      }
+    }
+    producer.join();
+    CHECK_UNARY(inOrder);
+  }
+}
+
+TEST_CASE("MpmcRing") {
+  SUBCASE("fifo, full and empty") {
+    MpmcRing<int> ring(2);
+    CHECK_UNARY(ring.tryPush(1));
+    CHECK_UNARY(ring.tryPush(2));
+    CHECK_UNARY_FALSE(ring.tryPush(3));
+    CHECK_EQ(ring.tryPop(), 1);
+    CHECK_UNARY(ring.tryPush(3));
+    CHECK_EQ(ring.tryPop(), 2);
+    CHECK_EQ(ring.tryPop(), 3);
+    CHECK_UNARY_FALSE(ring.tryPop().has_value());
+  }
+
+  SUBCASE("every element popped exactly once") {
+    constexpr int threads = 4;
+    constexpr int perThread = 20000;
+    MpmcRing<int> ring(16);
+    std::vector<std::vector<int>> popped(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&ring, t] {
+        for (int i = t * perThread; i < (t + 1) * perThread; ++i) {
+          while (!ring.tryPush(int{i})) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      workers.emplace_back([&ring, &out = popped[static_cast<std::size_t>(t)]] {
+        while (out.size() < perThread) {
+          if (const auto x = ring.tryPop()) {
+            out.push_back(*x);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+    std::vector<int> all;
+    for (const auto &p : popped) {
+      all.insert(all.end(), p.begin(), p.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<int> expected(threads * perThread);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      expected[i] = static_cast<int>(i);
+    }
+    CHECK_EQ(all, expected);
+  }
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Searches over integer intervals as plain loops, so that with a constexpr
+// predicate they run at compile time, and at run time never allocate.
+
+// Up to N values in place. Usable at compile time, where the
+// std::length_error of a push_back past N makes the search ill-formed.
+template <typename T, std::size_t N> class FixedVector {
+public:
+  constexpr FixedVector() = default;
+
+  constexpr void push_back(const T &x) {
+    if (size_ == N) {
+      throw std::length_error("FixedVector: full");
+    }
+    values_[size_++] = x;
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept { return size_; }
+  [[nodiscard]] constexpr bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] static constexpr std::size_t capacity() noexcept { return N; }
+  [[nodiscard]] constexpr const T &operator[](std::size_t i) const noexcept {
+    return values_[i];
+  }
+  [[nodiscard]] constexpr const T *begin() const noexcept {
+    return values_.data();
+  }
+  [[nodiscard]] constexpr const T *end() const noexcept {
+    return values_.data() + size_;
+  }
+
+  template <std::size_t M>
+  friend constexpr bool operator==(const FixedVector &a,
+                                   const std::array<T, M> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+  friend constexpr bool operator==(const FixedVector &a, const FixedVector &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+private:
+  std::array<T, N> values_{};
+  std::size_t size_ = 0;
+};
+
+// f(x) for every x in [first, last) with pred(x), at most N of them
+template <std::size_t N, std::integral I, typename Pred,
+          typename F = std::identity>
+[[nodiscard]] constexpr auto findAll(I first, I last, Pred pred, F f = {}) {
+  FixedVector<std::remove_cvref_t<std::invoke_result_t<F &, I>>, N> found;
+  for (I x = first; x < last; ++x) {
+    if (std::invoke(pred, x)) {
+      found.push_back(std::invoke(f, x));
+    }
+  }
+  return found;
+}
+
+// The first x in [first, last) with pred(x)
+template <std::integral I, typename Pred>
+[[nodiscard]] constexpr std::optional<I> findFirst(I first, I last, Pred pred) {
+  for (I x = first; x < last; ++x) {
+    if (std::invoke(pred, x)) {
+      return x;
+    }
+  }
+  return std::nullopt;
+}
+
+// How many x in [first, last) have pred(x)
+template <std::integral I, typename Pred>
+[[nodiscard]] constexpr std::size_t countIf(I first, I last, Pred pred) {
+  std::size_t n = 0;
+  for (I x = first; x < last; ++x) {
+    n += std::invoke(pred, x) ? 1U : 0U;
+  }
+  return n;
+}
+
+// What a visit of nestedSearch asks for next
+enum class Step {
+  // The next value of the innermost variable
+  Next,
+  // The next value of the one outside it, e.g. once a predicate that only
+  // grows with the innermost variable is too large
+  Break,
+  // Nothing more
+  Stop,
+};
+
+// The values first to last of a loop variable, both included like
+// views::closed_iota, none if last < first
+template <std::integral I> struct Bounds {
+  I first;
+  I last;
+};
+template <std::integral I> Bounds(I, I) -> Bounds<I>;
+
+namespace detail {
+// b itself, or the Bounds it computes from the outer variables
+template <typename B, typename... Xs>
+[[nodiscard]] constexpr auto boundsOf(const B &b, const Xs &...xs) {
+  if constexpr (std::is_invocable_v<const B &, const Xs &...>) {
+    return std::invoke(b, xs...);
+  } else {
+    return b;
+  }
+}
+
+template <typename Visit, typename... Xs>
+constexpr Step visitStep(Visit &visit, const Xs &...xs) {
+  if constexpr (std::is_void_v<std::invoke_result_t<Visit &, const Xs &...>>) {
+    std::invoke(visit, xs...);
+    return Step::Next;
+  } else {
+    return std::invoke(visit, xs...);
+  }
+}
+
+// The loops from the K-th variable in, for the values xs of the outer ones.
+// Only Next or Stop come out, a Break ends the innermost loop.
+template <std::size_t K, typename Tuple, typename Visit, typename... Xs>
+constexpr Step nestedLoop(const Tuple &bounds, Visit &visit, const Xs &...xs) {
+  const auto [first, last] = boundsOf(std::get<K>(bounds), xs...);
+  if (last < first) {
+    return Step::Next;
+  }
+  for (auto x = first;; ++x) {
+    const Step step = [&] {
+      if constexpr (K + 1 == std::tuple_size_v<Tuple>) {
+        return visitStep(visit, xs..., x);
+      } else {
+        return nestedLoop<K + 1>(bounds, visit, xs..., x);
+      }
+    }();
+    if (step == Step::Stop) {
+      return step;
+    }
+    if (step == Step::Break || x == last) {
+      return Step::Next;
+    }
+  }
+}
+} // namespace detail
+
+// Calls visit(x0, x1, ..., xk) for every point of the nested loops
+//   for x0 in bounds0, for x1 in bounds1(x0), ..., for xk in boundsk(x0..)
+// in that order. Every bound is a Bounds, or computes one from the values of
+// the variables outside it, so that the loops cover a triangle, say, instead
+// of a cube. visit returns void, or a Step to cut the search short. Returns
+// false if a visit stopped it.
+template <typename... B, typename Visit>
+  requires(sizeof...(B) > 0)
+constexpr bool nestedSearch(const std::tuple<B...> &bounds, Visit visit) {
+  return detail::nestedLoop<0>(bounds, visit) != Step::Stop;
+}
+
+// A right triangle with integer sides, a < b < c
+template <std::integral I> struct Triple {
+  I a;
+  I b;
+  I c;
+  friend constexpr bool operator==(const Triple &, const Triple &) = default;
+};
+
+// Every triple with c <= maxC, ordered by c then b. Each one is a multiple
+// k * (m^2 - n^2, 2mn, m^2 + n^2) of a primitive one, from Euclid's formula
+// with m > n coprime and not both odd, so only the about maxC log(maxC)
+// triples themselves are visited, instead of the cube of candidate sides.
+// Not constexpr, libstdc++ 11 of the flake has no constexpr std::vector.
+template <std::integral I>
+[[nodiscard]] std::vector<Triple<I>> pythagoreanTriples(I maxC) {
+  std::vector<Triple<I>> triples;
+  for (I m = 2; m * m + 1 <= maxC; ++m) {
+    for (I n = 1; n < m && m * m + n * n <= maxC; ++n) {
+      if ((m - n) % 2 == 0 || std::gcd(m, n) != 1) {
+        continue;
+      }
+      const I c = m * m + n * n;
+      const I a = std::min<I>(m * m - n * n, 2 * m * n);
+      const I b = std::max<I>(m * m - n * n, 2 * m * n);
+      for (I k = 1; k * c <= maxC; ++k) {
+        triples.push_back({k * a, k * b, k * c});
+      }
+    }
+  }
+  std::sort(triples.begin(), triples.end(),
+            [](const Triple<I> &x, const Triple<I> &y) {
+              return x.c != y.c ? x.c < y.c : x.b < y.b;
+            });
+  return triples;
+}
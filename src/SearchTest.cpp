@@ -0,0 +1,144 @@
+#include "DigitSet.hpp"
+#include "Search.hpp"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+// The "All-digit magic" of TryRangesTest: i and i * i are written with
+// every digit but 0 between them
+constexpr bool allDigitMagic(int i) {
+  return (DigitSet::of(i) | DigitSet::of(i * i)) == nonZeroDigits;
+}
+
+constexpr auto magic = findAll<4>(100, 1000, allDigitMagic,
+                                  [](int i) { return std::pair(i, i * i); });
+static_assert(magic ==
+              std::array{std::pair(567, 321489), std::pair(854, 729316)});
+static_assert(findFirst(100, 1000, allDigitMagic) == 567);
+static_assert(countIf(1, 10000, [](int i) { return distinctDigits(i); }) ==
+              5274);
+
+// Every triple with c <= maxC, from all a < b < c
+std::vector<Triple<int>> bruteForceTriples(int maxC) {
+  std::vector<Triple<int>> triples;
+  for (int c = 1; c <= maxC; ++c) {
+    for (int b = 1; b < c; ++b) {
+      for (int a = 1; a < b; ++a) {
+        if (a * a + b * b == c * c) {
+          triples.push_back({a, b, c});
+        }
+      }
+    }
+  }
+  return triples;
+}
+} // namespace
+
+TEST_CASE("findAll") {
+  SUBCASE("at run time too") {
+    auto found = findAll<4>(100, 1000, allDigitMagic);
+    constexpr std::array expected = {567, 854};
+    CHECK_EQ(found, expected);
+    CHECK_EQ(found.capacity(), 4);
+  }
+  SUBCASE("more than N values throw") {
+    CHECK_THROWS_AS((void)findAll<2>(0, 10, [](int) { return true; }),
+                    std::length_error);
+  }
+  SUBCASE("none") {
+    CHECK_UNARY(findAll<1>(0, 10, [](int) { return false; }).empty());
+    CHECK_UNARY_FALSE(findFirst(0, 10, [](int) { return false; }).has_value());
+    CHECK_EQ(countIf(5, 5, [](int) { return true; }), 0);
+  }
+}
+
+TEST_CASE("nestedSearch") {
+  using T = std::tuple<int, int, int>;
+  const std::vector expected = {T{3, 4, 5}, T{6, 8, 10}};
+
+  SUBCASE("over a cube, as triangles 1") {
+    std::vector<T> found;
+    const Bounds sides{1, 10};
+    CHECK_UNARY(nestedSearch(std::tuple(sides, sides, sides),
+                             [&](int x, int y, int z) {
+                               if (z > y && y >= x && x * x + y * y == z * z) {
+                                 found.emplace_back(x, y, z);
+                               }
+                             }));
+    CHECK_EQ(found, expected);
+  }
+
+  SUBCASE("bounds from the outer variables, as triangles 2") {
+    std::vector<T> found;
+    std::size_t visits = 0;
+    nestedSearch(std::tuple(Bounds{1, 10}, [](int c) { return Bounds{1, c}; },
+                            [](int, int b) { return Bounds{1, b}; }),
+                 [&](int c, int b, int a) {
+                   ++visits;
+                   if (a * a + b * b == c * c) {
+                     found.emplace_back(a, b, c);
+                   }
+                 });
+    CHECK_EQ(found, expected);
+    CHECK_EQ(visits, 220);
+  }
+
+  SUBCASE("Break prunes the innermost loop") {
+    std::vector<T> found;
+    std::size_t visits = 0;
+    nestedSearch(std::tuple(Bounds{1, 10}, [](int c) { return Bounds{1, c}; },
+                            [](int, int b) { return Bounds{1, b}; }),
+                 [&](int c, int b, int a) {
+                   ++visits;
+                   if (a * a + b * b > c * c) {
+                     return Step::Break;
+                   }
+                   if (a * a + b * b == c * c) {
+                     found.emplace_back(a, b, c);
+                   }
+                   return Step::Next;
+                 });
+    CHECK_EQ(found, expected);
+    CHECK_LT(visits, 220);
+  }
+
+  SUBCASE("Stop ends the search") {
+    std::vector<T> found;
+    CHECK_UNARY_FALSE(nestedSearch(
+        std::tuple(Bounds{1, 100}, [](int c) { return Bounds{1, c}; },
+                   [](int, int b) { return Bounds{1, b}; }),
+        [&](int c, int b, int a) {
+          if (a * a + b * b != c * c) {
+            return Step::Next;
+          }
+          found.emplace_back(a, b, c);
+          return found.size() == 2 ? Step::Stop : Step::Next;
+        }));
+    CHECK_EQ(found, expected);
+  }
+
+  SUBCASE("empty bounds") {
+    std::size_t visits = 0;
+    CHECK_UNARY(nestedSearch(std::tuple(Bounds{1, 0}), [&](int) { ++visits; }));
+    CHECK_UNARY(nestedSearch(
+        std::tuple(Bounds{0, 3}, [](int x) { return Bounds{1, x - 1}; }),
+        [&](int, int) { ++visits; }));
+    CHECK_EQ(visits, 3);
+  }
+}
+
+TEST_CASE("pythagoreanTriples") {
+  const std::vector upToTen{Triple{3, 4, 5}, Triple{6, 8, 10}};
+  CHECK_EQ(pythagoreanTriples(10), upToTen);
+  for (const int maxC : {0, 4, 5, 13, 25, 100, 500}) {
+    CHECK_EQ(pythagoreanTriples(maxC), bruteForceTriples(maxC));
+  }
+  CHECK_EQ(pythagoreanTriples(std::int64_t{100000}).size(), 161436);
+}
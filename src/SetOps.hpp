@@ -0,0 +1,357 @@
+#pragma once
+
+#include "Simd.hpp"
+
+#include <range/v3/functional/comparisons.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/primitives.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Union, intersection and difference of sorted sets, like views::set_union
+// and friends, but choosing how to merge from the sizes of the inputs. Unlike
+// those they take sets, not multisets: both inputs must be sorted by comp
+// and free of equivalent elements. Every function comes as a view,
+// fast_set_op(a, b, comp), and eagerly, fast_set_op(a, b, out, comp)
+// writing to the output iterator out and returning its end.
+//
+// Once one input is gallopRatio times longer than the other, the position
+// of every element of the shorter one in the longer is galloped to, in
+// O(log d) comparisons for a distance of d, so skipping a run costs about
+// log of its length, instead of its length. Eager intersections and
+// differences of 32 bit integers in contiguous memory, written to
+// contiguous memory, run on the simd::intersectSorted kernels otherwise.
+
+namespace detail {
+inline constexpr std::size_t gallopRatio = 32;
+
+enum class SetOp { Union, Intersection, Difference };
+
+[[nodiscard]] constexpr bool skewed(std::size_t n, std::size_t m) noexcept {
+  return std::min(n, m) * gallopRatio <= std::max(n, m);
+}
+
+// The first element of [first, last) not less than x, found by probing
+// first + 1, + 2, + 4 ... then a binary search of the last step
+template <std::random_access_iterator I, typename T, typename Comp>
+I gallop(I first, I last, const T &x, Comp &comp) {
+  if (first == last || !std::invoke(comp, *first, x)) {
+    return first;
+  }
+  const auto less = [&](const auto &y) { return std::invoke(comp, y, x); };
+  // *lo is less than x, the ones from hi on are not
+  I lo = first;
+  I hi = last;
+  for (std::iter_difference_t<I> step = 1; step < last - lo; step *= 2) {
+    if (!less(lo[step])) {
+      hi = lo + step;
+      break;
+    }
+    lo += step;
+  }
+  return std::partition_point(lo + 1, hi, less);
+}
+
+// gallop, or a linear scan where the elements are close
+template <std::random_access_iterator I, typename T, typename Comp>
+I seek(I first, I last, const T &x, Comp &comp, bool galloping) {
+  if (galloping) {
+    return gallop(first, last, x, comp);
+  }
+  while (first != last && std::invoke(comp, *first, x)) {
+    ++first;
+  }
+  return first;
+}
+
+// Whether an eager intersection or difference can run on the simd kernels
+template <typename A, typename B, typename O, typename Comp>
+concept simdSetOp =
+    ranges::contiguous_range<A> && ranges::contiguous_range<B> &&
+    std::contiguous_iterator<O> &&
+    (std::is_same_v<Comp, ranges::less> || std::is_same_v<Comp, std::less<>>) &&
+    std::is_same_v<ranges::range_value_t<A>, ranges::range_value_t<B>> &&
+    std::is_same_v<ranges::range_value_t<A>, std::iter_value_t<O>> &&
+    (std::is_same_v<ranges::range_value_t<A>, std::int32_t> ||
+     std::is_same_v<ranges::range_value_t<A>, std::uint32_t>);
+
+// The elements of the small range in the large one, or not in it if not
+// wanted, galloping through the large range. The kept elements come from a,
+// which may be either of them.
+template <bool SmallIsA, bool Wanted, typename S, typename L, typename O,
+          typename Comp>
+O gallopMatches(S small, S smallEnd, L large, L largeEnd, O out, Comp &comp) {
+  for (; small != smallEnd; ++small) {
+    large = gallop(large, largeEnd, *small, comp);
+    const bool found = large != largeEnd && !std::invoke(comp, *small, *large);
+    if (found == Wanted) {
+      if constexpr (SmallIsA) {
+        *out = *small;
+      } else {
+        *out = *large;
+      }
+      ++out;
+    }
+    large += found ? 1 : 0;
+  }
+  return out;
+}
+
+// The runs of the large range between the elements of the small one are
+// galloped over and copied whole. Keep says whether an element of the small
+// range is written, and with an equivalent one of the large range, which
+// one. Elements of the large range equivalent to one of the small range are
+// dropped.
+template <typename S, typename L, typename O, typename Comp, typename Keep>
+O gallopRuns(S small, S smallEnd, L large, L largeEnd, O out, Comp &comp,
+             Keep keep) {
+  for (; small != smallEnd; ++small) {
+    const L run = gallop(large, largeEnd, *small, comp);
+    out = std::copy(large, run, out);
+    large = run;
+    const bool found = large != largeEnd && !std::invoke(comp, *small, *large);
+    out = keep(small, large, found, out);
+    large += found ? 1 : 0;
+  }
+  return std::copy(large, largeEnd, out);
+}
+
+template <SetOp Op, typename A, typename B, typename O, typename Comp>
+O eagerSetOp(A &&a, B &&b, O out, Comp &comp) {
+  const auto n = static_cast<std::size_t>(ranges::size(a));
+  const auto m = static_cast<std::size_t>(ranges::size(b));
+  auto af = ranges::begin(a);
+  auto al = ranges::end(a);
+  auto bf = ranges::begin(b);
+  auto bl = ranges::end(b);
+  if constexpr (Op == SetOp::Union) {
+    if (!skewed(n, m)) {
+      return std::set_union(af, al, bf, bl, std::move(out), comp);
+    }
+    if (n < m) {
+      return gallopRuns(af, al, bf, bl, std::move(out), comp,
+                        [](auto x, auto, bool, O o) {
+                          *o = *x;
+                          return ++o;
+                        });
+    }
+    return gallopRuns(bf, bl, af, al, std::move(out), comp,
+                      [](auto x, auto y, bool found, O o) {
+                        *o = found ? *y : *x;
+                        return ++o;
+                      });
+  } else {
+    constexpr bool intersection = Op == SetOp::Intersection;
+    if (skewed(n, m)) {
+      if (n < m) {
+        return gallopMatches<true, intersection>(af, al, bf, bl,
+                                                 std::move(out), comp);
+      }
+      if constexpr (intersection) {
+        return gallopMatches<false, true>(bf, bl, af, al, std::move(out),
+                                          comp);
+      } else {
+        return gallopRuns(bf, bl, af, al, std::move(out), comp,
+                          [](auto, auto, bool, O o) { return o; });
+      }
+    }
+    if constexpr (simdSetOp<A, B, O, Comp>) {
+      const auto *p = ranges::data(a);
+      const auto *q = ranges::data(b);
+      auto *r = std::to_address(out);
+      return out + static_cast<std::iter_difference_t<O>>(
+                       intersection ? simd::intersectSorted(p, n, q, m, r)
+                                    : simd::differenceSorted(p, n, q, m, r));
+    } else if constexpr (intersection) {
+      return std::set_intersection(af, al, bf, bl, std::move(out), comp);
+    } else {
+      return std::set_difference(af, al, bf, bl, std::move(out), comp);
+    }
+  }
+}
+
+template <typename R>
+concept setRange = ranges::random_access_range<R> && ranges::sized_range<R>;
+
+template <typename Comp, typename A, typename B>
+concept setOrder =
+    std::predicate<Comp &, ranges::range_reference_t<A>,
+                   ranges::range_reference_t<B>> &&
+    std::predicate<Comp &, ranges::range_reference_t<B>,
+                   ranges::range_reference_t<A>>;
+} // namespace detail
+
+// The lazy form of the fast_set_ functions. Galloping is decided once, at
+// construction, and only intersections and differences skip, a union visits
+// every element anyway.
+template <detail::SetOp Op, typename A, typename B, typename Comp>
+  requires ranges::view_<A> && ranges::view_<B> && detail::setRange<A> &&
+           detail::setRange<B>
+class fast_set_view
+    : public ranges::view_interface<fast_set_view<Op, A, B, Comp>> {
+public:
+  class iterator {
+  public:
+    using reference =
+        std::conditional_t<Op == detail::SetOp::Union,
+                           std::common_reference_t<
+                               ranges::range_reference_t<const A>,
+                               ranges::range_reference_t<const B>>,
+                           ranges::range_reference_t<const A>>;
+    using value_type = std::remove_cvref_t<reference>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+
+    reference operator*() const {
+      if constexpr (Op == detail::SetOp::Union) {
+        if (fromB_) {
+          return *b_;
+        }
+      }
+      return *a_;
+    }
+    iterator &operator++() {
+      if constexpr (Op == detail::SetOp::Union) {
+        if (fromB_) {
+          ++b_;
+        } else {
+          if (b_ != bEnd() && !std::invoke(comp(), *a_, *b_)) {
+            ++b_;
+          }
+          ++a_;
+        }
+      } else {
+        ++a_;
+        if constexpr (Op == detail::SetOp::Intersection) {
+          ++b_;
+        }
+      }
+      satisfy();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    friend bool operator==(const iterator &x, const iterator &y) {
+      return x.a_ == y.a_ && x.b_ == y.b_;
+    }
+
+  private:
+    friend fast_set_view;
+    using AIt = ranges::iterator_t<const A>;
+    using BIt = ranges::iterator_t<const B>;
+
+    iterator(const fast_set_view *parent, AIt a, BIt b)
+        : parent_(parent), a_(std::move(a)), b_(std::move(b)) {
+      satisfy();
+    }
+
+    [[nodiscard]] Comp &comp() const { return parent_->comp_; }
+    [[nodiscard]] AIt aEnd() const { return ranges::end(parent_->a_); }
+    [[nodiscard]] BIt bEnd() const { return ranges::end(parent_->b_); }
+
+    // Moves to the next element of the result, or to the end of both inputs
+    void satisfy() {
+      if constexpr (Op == detail::SetOp::Union) {
+        fromB_ = a_ == aEnd() ||
+                 (b_ != bEnd() && std::invoke(comp(), *b_, *a_));
+      } else if constexpr (Op == detail::SetOp::Intersection) {
+        while (a_ != aEnd() && b_ != bEnd()) {
+          if (std::invoke(comp(), *a_, *b_)) {
+            a_ = detail::seek(a_, aEnd(), *b_, comp(), parent_->gallopA_);
+          } else if (std::invoke(comp(), *b_, *a_)) {
+            b_ = detail::seek(b_, bEnd(), *a_, comp(), parent_->gallopB_);
+          } else {
+            return;
+          }
+        }
+        a_ = aEnd();
+        b_ = bEnd();
+      } else {
+        for (; a_ != aEnd(); ++a_, ++b_) {
+          b_ = detail::seek(b_, bEnd(), *a_, comp(), parent_->gallopB_);
+          if (b_ == bEnd() || std::invoke(comp(), *a_, *b_)) {
+            return;
+          }
+        }
+        b_ = bEnd();
+      }
+    }
+
+    const fast_set_view *parent_ = nullptr;
+    AIt a_{};
+    BIt b_{};
+    bool fromB_ = false;
+  };
+
+  fast_set_view() = default;
+  fast_set_view(A a, B b, Comp comp)
+      : a_(std::move(a)), b_(std::move(b)), comp_(std::move(comp)) {
+    const auto n = static_cast<std::size_t>(ranges::size(a_));
+    const auto m = static_cast<std::size_t>(ranges::size(b_));
+    gallopA_ = detail::skewed(n, m) && m < n;
+    gallopB_ = detail::skewed(n, m) && n < m;
+  }
+
+  [[nodiscard]] iterator begin() const {
+    return {this, ranges::begin(a_), ranges::begin(b_)};
+  }
+  [[nodiscard]] iterator end() const {
+    return {this, ranges::end(a_), ranges::end(b_)};
+  }
+
+private:
+  A a_;
+  B b_;
+  // Called from the const iterators, comparisons are not required to be
+  // const callable
+  mutable Comp comp_;
+  bool gallopA_ = false;
+  bool gallopB_ = false;
+};
+
+namespace detail {
+template <SetOp Op> struct FastSetFn {
+  template <typename A, typename B, typename Comp = ranges::less>
+    requires ranges::viewable_range<A> && ranges::viewable_range<B> &&
+             setRange<A> && setRange<B> && setOrder<Comp, A, B>
+  auto operator()(A &&a, B &&b, Comp comp = {}) const {
+    return fast_set_view<Op, ranges::views::all_t<A>, ranges::views::all_t<B>,
+                         Comp>(ranges::views::all(std::forward<A>(a)),
+                               ranges::views::all(std::forward<B>(b)),
+                               std::move(comp));
+  }
+
+  template <typename A, typename B, std::weakly_incrementable O,
+            typename Comp = ranges::less>
+    requires setRange<A> && setRange<B> && setOrder<Comp, A, B>
+  O operator()(A &&a, B &&b, O out, Comp comp = {}) const {
+    return eagerSetOp<Op>(a, b, std::move(out), comp);
+  }
+};
+} // namespace detail
+
+// The elements in either set, from a where both have one
+inline constexpr detail::FastSetFn<detail::SetOp::Union> fast_set_union;
+// The elements of a that b has too
+inline constexpr detail::FastSetFn<detail::SetOp::Intersection>
+    fast_set_intersection;
+// The elements of a that b does not have
+inline constexpr detail::FastSetFn<detail::SetOp::Difference>
+    fast_set_difference;
@@ -0,0 +1,89 @@
+#include "Bench.hpp"
+#include "SetOps.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <range/v3/algorithm/copy.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+using Set = std::vector<int>;
+
+// Two random sets, together size bytes, the second one ratio times longer
+std::pair<Set, Set> makeSets(std::size_t size, std::size_t ratio) {
+  std::mt19937 gen(42);
+  const auto make = [&](std::size_t n, unsigned spread) {
+    std::uniform_int_distribution<int> gap(1, static_cast<int>(spread));
+    Set v(n);
+    int x = 0;
+    for (auto &e : v) {
+      e = x += gap(gen);
+    }
+    return v;
+  };
+  const std::size_t n =
+      std::max<std::size_t>(size / sizeof(int) / (ratio + 1), 1);
+  // About the same value range for both, so they overlap throughout
+  return {make(n, static_cast<unsigned>(4 * ratio)), make(n * ratio, 4)};
+}
+
+template <typename Op>
+void BM_setOp(benchmark::State &state, std::size_t ratio, Op op) {
+  const auto [a, b] = makeSets(bench::inputSize(state), ratio);
+  Set out(a.size() + b.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(a, b, out.data()));
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto intersectionStd = [](const Set &a, const Set &b, int *out) {
+  return std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), out);
+};
+const auto intersectionFast = [](const Set &a, const Set &b, int *out) {
+  return fast_set_intersection(a, b, out);
+};
+const auto intersectionView = [](const Set &a, const Set &b, int *out) {
+  return ranges::copy(fast_set_intersection(a, b), out).out;
+};
+const auto differenceStd = [](const Set &a, const Set &b, int *out) {
+  return std::set_difference(a.begin(), a.end(), b.begin(), b.end(), out);
+};
+const auto differenceFast = [](const Set &a, const Set &b, int *out) {
+  return fast_set_difference(a, b, out);
+};
+const auto unionStd = [](const Set &a, const Set &b, int *out) {
+  return std::set_union(a.begin(), a.end(), b.begin(), b.end(), out);
+};
+const auto unionFast = [](const Set &a, const Set &b, int *out) {
+  return fast_set_union(a, b, out);
+};
+} // namespace
+
+BENCHMARK_CAPTURE(BM_setOp, intersection_std, 1, intersectionStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_fast, 1, intersectionFast)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_std_skewed, 1000, intersectionStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_fast_skewed, 1000, intersectionFast)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_view_skewed, 1000, intersectionView)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_std, 1, differenceStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_fast, 1, differenceFast)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_std_skewed, 1000, differenceStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_fast_skewed, 1000, differenceFast)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, union_std_skewed, 1000, unionStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, union_fast_skewed, 1000, unionFast)
+    ->Apply(bench::inputSizes);
@@ -0,0 +1,188 @@
+#include "SetOps.hpp"
+#include "SimdTestSupport.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// n distinct values, increasing, with gaps of up to spread
+template <typename T>
+std::vector<T> randomSet(std::size_t n, unsigned spread, std::mt19937 &gen) {
+  std::uniform_int_distribution<unsigned> gap(1, spread);
+  std::vector<T> v(n);
+  T x = 0;
+  for (auto &e : v) {
+    x = static_cast<T>(x + static_cast<T>(gap(gen)));
+    e = x;
+  }
+  return v;
+}
+
+// Pairs of sets, small and large against each other in either order, dense
+// and sparse
+template <typename T, typename F> void forEachPair(F f) {
+  std::mt19937 gen(19);
+  for (const std::size_t n : {0U, 1U, 3U, 7U, 8U, 9U, 33U, 100U, 1000U}) {
+    for (const std::size_t m : {0U, 1U, 5U, 16U, 17U, 64U, 1000U, 40000U}) {
+      for (const unsigned spread : {1U, 3U, 40U}) {
+        const auto a = randomSet<T>(n, spread, gen);
+        const auto b = randomSet<T>(m, spread, gen);
+        f(a, b);
+        f(b, a);
+      }
+    }
+  }
+}
+
+template <typename T> std::vector<T> stdUnion(const std::vector<T> &a,
+                                              const std::vector<T> &b) {
+  std::vector<T> out;
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                 std::back_inserter(out));
+  return out;
+}
+
+template <typename T> std::vector<T> stdIntersection(const std::vector<T> &a,
+                                                     const std::vector<T> &b) {
+  std::vector<T> out;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(out));
+  return out;
+}
+
+template <typename T> std::vector<T> stdDifference(const std::vector<T> &a,
+                                                   const std::vector<T> &b) {
+  std::vector<T> out;
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::back_inserter(out));
+  return out;
+}
+
+// The eager form into a buffer of exactly the result's size, so that the
+// kernels are also checked for not writing past it
+template <typename T, typename Fn>
+std::vector<T> eager(const Fn &fn, const std::vector<T> &a,
+                     const std::vector<T> &b, std::size_t size) {
+  std::vector<T> out(size);
+  const auto end = fn(a, b, out.data());
+  CHECK_EQ(end - out.data(), static_cast<std::ptrdiff_t>(size));
+  return out;
+}
+} // namespace
+
+TEST_CASE("fast_set_intersection") {
+  SUBCASE("same as std::set_intersection, with every isa") {
+    forEachIsa([&](simd::Isa) {
+      forEachPair<std::int32_t>([](const auto &a, const auto &b) {
+        const auto expected = stdIntersection(a, b);
+        CHECK_EQ(eager(fast_set_intersection, a, b, expected.size()),
+                 expected);
+        CHECK_EQ(fast_set_intersection(a, b) | ranges::to<std::vector>(),
+                 expected);
+      });
+      forEachPair<std::uint32_t>([](const auto &a, const auto &b) {
+        const auto expected = stdIntersection(a, b);
+        CHECK_EQ(eager(fast_set_intersection, a, b, expected.size()),
+                 expected);
+      });
+    });
+  }
+
+  SUBCASE("unsigned values above INT32_MAX keep their order") {
+    const std::vector<std::uint32_t> a = {1,          5,          9,
+                                          0x7fffffff, 0x80000000, 0x80000001,
+                                          0xfffffff0, 0xffffffff};
+    const std::vector<std::uint32_t> b = {5,          0x7fffffff, 0x80000001,
+                                          0x90000000, 0xfffffff0, 0xfffffffe,
+                                          0xffffffff};
+    const std::vector<std::uint32_t> expected = {5, 0x7fffffff, 0x80000001,
+                                                 0xfffffff0, 0xffffffff};
+    CHECK_EQ(eager(fast_set_intersection, a, b, expected.size()), expected);
+  }
+
+  SUBCASE("an output iterator and a comparison") {
+    const std::vector<std::string> a = {"pear", "kiwi", "fig", "apple"};
+    const std::vector<std::string> b = {"plum", "kiwi", "apple"};
+    std::vector<std::string> out;
+    fast_set_intersection(a, b, std::back_inserter(out), std::greater<>());
+    const std::vector<std::string> expected = {"kiwi", "apple"};
+    CHECK_EQ(out, expected);
+    CHECK_EQ(fast_set_intersection(a, b, std::greater<>()) |
+                 ranges::to<std::vector>(),
+             out);
+  }
+}
+
+TEST_CASE("fast_set_difference") {
+  SUBCASE("same as std::set_difference, with every isa") {
+    forEachIsa([&](simd::Isa) {
+      forEachPair<std::int32_t>([](const auto &a, const auto &b) {
+        const auto expected = stdDifference(a, b);
+        CHECK_EQ(eager(fast_set_difference, a, b, expected.size()), expected);
+        CHECK_EQ(fast_set_difference(a, b) | ranges::to<std::vector>(),
+                 expected);
+      });
+      forEachPair<std::uint32_t>([](const auto &a, const auto &b) {
+        const auto expected = stdDifference(a, b);
+        CHECK_EQ(eager(fast_set_difference, a, b, expected.size()), expected);
+      });
+    });
+  }
+
+  SUBCASE("an output iterator and a comparison") {
+    const std::vector<std::string> a = {"pear", "kiwi", "fig", "apple"};
+    const std::vector<std::string> b = {"plum", "kiwi", "apple"};
+    std::vector<std::string> out;
+    fast_set_difference(a, b, std::back_inserter(out), std::greater<>());
+    const std::vector<std::string> expected = {"pear", "fig"};
+    CHECK_EQ(out, expected);
+    CHECK_EQ(fast_set_difference(a, b, std::greater<>()) |
+                 ranges::to<std::vector>(),
+             out);
+  }
+}
+
+TEST_CASE("fast_set_union") {
+  SUBCASE("same as std::set_union") {
+    forEachPair<std::int32_t>([](const auto &a, const auto &b) {
+      const auto expected = stdUnion(a, b);
+      CHECK_EQ(eager(fast_set_union, a, b, expected.size()), expected);
+      CHECK_EQ(fast_set_union(a, b) | ranges::to<std::vector>(), expected);
+    });
+  }
+
+  SUBCASE("equivalent elements come from a") {
+    struct Item {
+      int key;
+      char from;
+      bool operator==(const Item &) const = default;
+    };
+    const auto byKey = [](const Item &x, const Item &y) {
+      return x.key < y.key;
+    };
+    std::vector<Item> a;
+    for (int i = 0; i < 100; ++i) {
+      a.push_back({i * 2, 'a'});
+    }
+    const std::vector<Item> b = {{3, 'b'}, {4, 'b'}, {150, 'b'}};
+    for (const auto &[x, y] : {std::pair{a, b}, std::pair{b, a}}) {
+      std::vector<Item> expected;
+      std::set_union(x.begin(), x.end(), y.begin(), y.end(),
+                     std::back_inserter(expected), byKey);
+      std::vector<Item> out;
+      fast_set_union(x, y, std::back_inserter(out), byKey);
+      CHECK_EQ(out, expected);
+      CHECK_EQ(fast_set_union(x, y, byKey) | ranges::to<std::vector>(),
+               expected);
+    }
+  }
+}
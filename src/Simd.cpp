@@ -0,0 +1,924 @@
+#include "Simd.hpp"
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TRY_RANGES_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define TRY_RANGES_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+namespace {
+std::uint64_t matchMaskScalar(const char *block, char c) noexcept {
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; ++i) {
+    m |= std::uint64_t{block[i] == c} << i;
+  }
+  return m;
+}
+
+std::uint64_t rangeMaskScalar(const char *block, char lo, char hi) noexcept {
+  const auto width = static_cast<unsigned char>(hi - lo);
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; ++i) {
+    m |= std::uint64_t{static_cast<unsigned char>(block[i] - lo) <= width}
+         << i;
+  }
+  return m;
+}
+
+std::uint64_t setMaskScalar(const char *block, const SetTable &set) noexcept {
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; ++i) {
+    const auto c = static_cast<unsigned char>(block[i]);
+    const auto &row = c < 128 ? set.low : set.high;
+    m |= std::uint64_t{(unsigned{row[c % 16U]} >> (c / 16U % 8U) & 1U) != 0}
+         << i;
+  }
+  return m;
+}
+
+#ifdef TRY_RANGES_SIMD_X86
+__attribute__((target("sse2"))) std::uint64_t
+matchMaskSse2(const char *block, char c) noexcept {
+  const __m128i needle = _mm_set1_epi8(c);
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+    const auto bits =
+        static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+    m |= std::uint64_t{bits} << i;
+  }
+  return m;
+}
+
+// x - lo <= hi - lo as unsigned bytes, i.e. max(x - lo, hi - lo) == hi - lo
+__attribute__((target("sse2"))) std::uint64_t
+rangeMaskSse2(const char *block, char lo, char hi) noexcept {
+  const __m128i first = _mm_set1_epi8(lo);
+  const __m128i width = _mm_set1_epi8(static_cast<char>(hi - lo));
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; i += 16) {
+    const __m128i x = _mm_sub_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i)), first);
+    const auto bits = static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(x, width), width)));
+    m |= std::uint64_t{bits} << i;
+  }
+  return m;
+}
+
+__attribute__((target("avx2"))) std::uint64_t
+matchMaskAvx2(const char *block, char c) noexcept {
+  const __m256i needle = _mm256_set1_epi8(c);
+  const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+  const __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+  const auto mlo = static_cast<std::uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+  const auto mhi = static_cast<std::uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+  return std::uint64_t{mlo} | (std::uint64_t{mhi} << 32U);
+}
+
+__attribute__((target("avx2"))) std::uint64_t
+rangeMaskAvx2(const char *block, char lo, char hi) noexcept {
+  const __m256i first = _mm256_set1_epi8(lo);
+  const __m256i width = _mm256_set1_epi8(static_cast<char>(hi - lo));
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; i += 32) {
+    const __m256i x = _mm256_sub_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i)),
+        first);
+    const auto bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_max_epu8(x, width), width)));
+    m |= std::uint64_t{bits} << i;
+  }
+  return m;
+}
+
+// Looks up the row of every byte by its low nibble, in the table picked by its
+// top bit, and tests the bit of its high nibble in that row
+__attribute__((target("avx2"))) std::uint64_t
+setMaskAvx2(const char *block, const SetTable &set) noexcept {
+  const __m256i low = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(set.low.data())));
+  const __m256i high = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(set.high.data())));
+  const __m256i bits = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+      16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  std::uint64_t m = 0;
+  for (std::size_t i = 0; i < BlockSize; i += 32) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+    const __m256i l = _mm256_and_si256(v, nibble);
+    const __m256i h = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, l),
+                                           _mm256_shuffle_epi8(high, l), v);
+    const __m256i bit = _mm256_shuffle_epi8(bits, h);
+    const auto in = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+    m |= std::uint64_t{in} << i;
+  }
+  return m;
+}
+
+// Counts in [p, p + n), n a multiple of 32. Matches are accumulated as bytes
+// and widened every 255 vectors, before they can overflow.
+__attribute__((target("avx2"))) std::size_t countAvx2(const char *p,
+                                                      std::size_t n,
+                                                      char c) noexcept {
+  const __m256i needle = _mm256_set1_epi8(c);
+  __m256i total = _mm256_setzero_si256();
+  for (std::size_t i = 0; i < n;) {
+    __m256i bytes = _mm256_setzero_si256();
+    for (const std::size_t stop = std::min(n, i + 255 * 32); i < stop;
+         i += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+      // A match is all ones, i.e. -1
+      bytes = _mm256_sub_epi8(bytes, _mm256_cmpeq_epi8(v, needle));
+    }
+    total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+  return static_cast<std::size_t>(_mm256_extract_epi64(total, 0) +
+                                  _mm256_extract_epi64(total, 1) +
+                                  _mm256_extract_epi64(total, 2) +
+                                  _mm256_extract_epi64(total, 3));
+}
+#endif
+
+#ifdef TRY_RANGES_SIMD_NEON
+std::uint64_t matchMaskNeon(const char *block, char c) noexcept {
+  // NEON has no movemask, weight every lane by its bit and fold with pairwise
+  // adds instead
+  const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+  const uint8x16_t weights = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                              0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+  const auto *p = reinterpret_cast<const uint8_t *>(block);
+  const uint8x16_t m0 = vandq_u8(vceqq_u8(vld1q_u8(p), needle), weights);
+  const uint8x16_t m1 = vandq_u8(vceqq_u8(vld1q_u8(p + 16), needle), weights);
+  const uint8x16_t m2 = vandq_u8(vceqq_u8(vld1q_u8(p + 32), needle), weights);
+  const uint8x16_t m3 = vandq_u8(vceqq_u8(vld1q_u8(p + 48), needle), weights);
+  uint8x16_t sum = vpaddq_u8(vpaddq_u8(m0, m1), vpaddq_u8(m2, m3));
+  sum = vpaddq_u8(sum, sum);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#endif
+
+#ifdef TRY_RANGES_SIMD_NEON
+std::uint64_t rangeMaskNeon(const char *block, char lo, char hi) noexcept {
+  const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(lo));
+  const uint8x16_t width = vdupq_n_u8(static_cast<uint8_t>(hi - lo));
+  const uint8x16_t weights = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                              0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+  const auto *p = reinterpret_cast<const uint8_t *>(block);
+  const auto in = [&](std::size_t i) {
+    return vandq_u8(vcleq_u8(vsubq_u8(vld1q_u8(p + i), first), width),
+                    weights);
+  };
+  uint8x16_t sum =
+      vpaddq_u8(vpaddq_u8(in(0), in(16)), vpaddq_u8(in(32), in(48)));
+  sum = vpaddq_u8(sum, sum);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#endif
+
+#ifdef TRY_RANGES_SIMD_NEON
+std::uint64_t setMaskNeon(const char *block, const SetTable &set) noexcept {
+  const uint8x16_t low = vld1q_u8(set.low.data());
+  const uint8x16_t high = vld1q_u8(set.high.data());
+  const uint8x16_t bits = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                           0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+  const auto *p = reinterpret_cast<const uint8_t *>(block);
+  const auto in = [&](std::size_t i) {
+    const uint8x16_t v = vld1q_u8(p + i);
+    const uint8x16_t l = vandq_u8(v, vdupq_n_u8(0x0f));
+    const uint8x16_t row =
+        vbslq_u8(vcgeq_u8(v, vdupq_n_u8(0x80)), vqtbl1q_u8(high, l),
+                 vqtbl1q_u8(low, l));
+    const uint8x16_t bit =
+        vqtbl1q_u8(bits, vandq_u8(vshrq_n_u8(v, 4), vdupq_n_u8(0x07)));
+    return vandq_u8(vtstq_u8(row, bit), bits);
+  };
+  uint8x16_t sum =
+      vpaddq_u8(vpaddq_u8(in(0), in(16)), vpaddq_u8(in(32), in(48)));
+  sum = vpaddq_u8(sum, sum);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#endif
+
+// The sum kernels. V is a vector extension type, or T itself for the scalar
+// one, lowered to the instructions of the function this is inlined into.
+template <typename V, typename T>
+[[gnu::always_inline]] inline T sumLanes(const T *p, std::size_t n,
+                                         bool compensated) noexcept {
+  constexpr std::size_t width = sizeof(V) / sizeof(T);
+  // Independent accumulators to cover the latency of the adds
+  constexpr std::size_t unroll = 4;
+  constexpr std::size_t step = width * unroll;
+  V s[unroll] = {};
+  V c[unroll] = {};
+  std::size_t i = 0;
+  if (compensated) {
+    for (; i + step <= n; i += step) {
+#pragma GCC unroll 4
+      for (std::size_t u = 0; u < unroll; ++u) {
+        V x;
+        std::memcpy(&x, p + i + u * width, sizeof(x));
+        const V y = x - c[u];
+        const V t = s[u] + y;
+        c[u] = (t - s[u]) - y;
+        s[u] = t;
+      }
+    }
+  } else {
+    for (; i + step <= n; i += step) {
+#pragma GCC unroll 4
+      for (std::size_t u = 0; u < unroll; ++u) {
+        V x;
+        std::memcpy(&x, p + i + u * width, sizeof(x));
+        s[u] += x;
+      }
+    }
+  }
+  T lanes[step];
+  T errors[step];
+  std::memcpy(lanes, s, sizeof(s));
+  std::memcpy(errors, c, sizeof(c));
+  T total = 0;
+  T error = 0;
+  const auto add = [&](T x) {
+    const T y = x - error;
+    const T t = total + y;
+    error = (t - total) - y;
+    total = t;
+  };
+  for (std::size_t k = 0; k < step; ++k) {
+    add(lanes[k]);
+    add(-errors[k]);
+  }
+  for (; i < n; ++i) {
+    add(p[i]);
+  }
+  return total;
+}
+
+#if defined(TRY_RANGES_SIMD_X86) || defined(TRY_RANGES_SIMD_NEON)
+typedef double F64x2 __attribute__((vector_size(16)));
+typedef float F32x4 __attribute__((vector_size(16)));
+#endif
+
+#ifdef TRY_RANGES_SIMD_X86
+typedef double F64x4 __attribute__((vector_size(32)));
+typedef float F32x8 __attribute__((vector_size(32)));
+
+template <typename V, typename T>
+__attribute__((target("sse2"))) T sumSse2(const T *p, std::size_t n,
+                                         bool compensated) noexcept {
+  return sumLanes<V>(p, n, compensated);
+}
+
+template <typename V, typename T>
+__attribute__((target("avx2"))) T sumAvx2(const T *p, std::size_t n,
+                                         bool compensated) noexcept {
+  return sumLanes<V>(p, n, compensated);
+}
+#endif
+
+// V16 and V32 are the 16 and 32 byte vectors of T
+template <typename T, typename V16, typename V32>
+T sumDispatch(const T *p, std::size_t n, bool compensated) noexcept {
+  switch (activeIsa()) {
+  case Isa::Scalar:
+    break;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return sumSse2<V16>(p, n, compensated);
+  case Isa::Avx2:
+    return sumAvx2<V32>(p, n, compensated);
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return sumLanes<V16>(p, n, compensated);
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return sumLanes<T>(p, n, compensated);
+}
+
+// Merges a[i, n) with b[j, m) one value at a time, writing the values of a
+// that are in b if matched, the others if not. Bit l of found is set if
+// a[i + l] is already known to be in b.
+template <typename T>
+std::size_t matchTail(const T *a, std::size_t n, const T *b, std::size_t m,
+                      T *out, bool matched, std::size_t i, std::size_t j,
+                      std::uint32_t found, std::size_t k) noexcept {
+  for (std::size_t l = 0; i < n; ++i, ++l) {
+    bool inB = l < 32 && (found >> l & 1U) != 0;
+    if (!inB) {
+      while (j < m && b[j] < a[i]) {
+        ++j;
+      }
+      inB = j < m && b[j] == a[i];
+    }
+    if (inB == matched) {
+      out[k++] = a[i];
+    }
+  }
+  return k;
+}
+
+// The intersectSorted and differenceSorted kernels. V is a vector extension
+// type of 32 bit lanes, only ever compared for equality so it serves signed
+// and unsigned T alike, lowered to the instructions of the function this is inlined
+// into. Every block of a is found in the blocks of b up to the one whose
+// last value is not less than its own, since both are strictly increasing.
+template <typename V, typename T>
+[[gnu::always_inline]] inline std::size_t
+matchBlocks(const T *a, std::size_t n, const T *b, std::size_t m, T *out,
+            bool matched) noexcept {
+  constexpr std::size_t width = sizeof(V) / sizeof(T);
+  std::size_t i = 0;
+  std::size_t j = 0;
+  std::size_t k = 0;
+  std::uint32_t found = 0;
+  while (i + width <= n && j + width <= m) {
+    V x;
+    std::memcpy(&x, a + i, sizeof(x));
+    V eq = {};
+#pragma GCC unroll 8
+    for (std::size_t l = 0; l < width; ++l) {
+      eq |= x == V{} + std::bit_cast<std::int32_t>(b[j + l]);
+    }
+#pragma GCC unroll 8
+    for (std::size_t l = 0; l < width; ++l) {
+      found |= std::uint32_t{eq[l] != 0} << l;
+    }
+    const T aLast = a[i + width - 1];
+    const T bLast = b[j + width - 1];
+    if (aLast <= bLast) {
+      for (std::uint32_t w = matched ? found : ~found & ((1U << width) - 1);
+           w != 0; w &= w - 1) {
+        out[k++] = a[i + static_cast<std::size_t>(std::countr_zero(w))];
+      }
+      i += width;
+      found = 0;
+    }
+    if (bLast <= aLast) {
+      j += width;
+    }
+  }
+  return matchTail(a, n, b, m, out, matched, i, j, found, k);
+}
+
+#if defined(TRY_RANGES_SIMD_X86) || defined(TRY_RANGES_SIMD_NEON)
+typedef std::int32_t I32x4 __attribute__((vector_size(16)));
+#endif
+
+#ifdef TRY_RANGES_SIMD_X86
+typedef std::int32_t I32x8 __attribute__((vector_size(32)));
+
+template <typename V, typename T>
+__attribute__((target("sse2"))) std::size_t
+matchSse2(const T *a, std::size_t n, const T *b, std::size_t m, T *out,
+          bool matched) noexcept {
+  return matchBlocks<V>(a, n, b, m, out, matched);
+}
+
+template <typename V, typename T>
+__attribute__((target("avx2"))) std::size_t
+matchAvx2(const T *a, std::size_t n, const T *b, std::size_t m, T *out,
+          bool matched) noexcept {
+  return matchBlocks<V>(a, n, b, m, out, matched);
+}
+#endif
+
+template <typename T>
+std::size_t matchDispatch(const T *a, std::size_t n, const T *b, std::size_t m,
+                          T *out, bool matched) noexcept {
+  switch (activeIsa()) {
+  case Isa::Scalar:
+    break;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return matchSse2<I32x4>(a, n, b, m, out, matched);
+  case Isa::Avx2:
+    return matchAvx2<I32x8>(a, n, b, m, out, matched);
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return matchBlocks<I32x4>(a, n, b, m, out, matched);
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return matchTail(a, n, b, m, out, matched, 0, 0, 0, 0);
+}
+
+// x becomes fill[0, Shift) followed by x[0, width - Shift). Vectors are
+// passed by reference, a 32 byte one by value would need AVX in the caller.
+// Clang only has __builtin_shufflevector, GCC before 12 only
+// __builtin_shuffle.
+template <std::size_t Shift, typename V, std::size_t... J>
+[[gnu::always_inline]] inline void
+shiftUp(const V &fill, V &x, std::index_sequence<J...>) noexcept {
+  constexpr std::size_t width = sizeof...(J);
+#ifdef __clang__
+  x = __builtin_shufflevector(fill, x, (J < Shift ? J : width + J - Shift)...);
+#else
+  using M = decltype(V{} < V{});
+  using E = std::remove_cvref_t<decltype(M{}[0])>;
+  x = __builtin_shuffle(
+      fill, x, M{static_cast<E>(J < Shift ? J : width + J - Shift)...});
+#endif
+}
+
+template <std::size_t Shift, typename V>
+[[gnu::always_inline]] inline void shiftUp(const V &fill, V &x) noexcept {
+  shiftUp<Shift>(fill, x,
+                 std::make_index_sequence<sizeof(V) / sizeof(x[0])>());
+}
+
+template <std::size_t Shift = 1, typename V>
+[[gnu::always_inline]] inline void scanLanes(V &x) noexcept {
+  constexpr std::size_t width = sizeof(V) / sizeof(x[0]);
+  if constexpr (Shift < width) {
+    V shifted = x;
+    shiftUp<Shift>(V{}, shifted);
+    x += shifted;
+    scanLanes<Shift * 2>(x);
+  }
+}
+
+// The prefix sum kernels, V as for sumLanes. A vector is scanned by
+// log2(width) adds of itself shifted up by 1, 2, 4... lanes, then gets the
+// total of the vectors before it, carry, added to every lane.
+template <typename V, typename T>
+[[gnu::always_inline]] inline T prefixSumLanes(const T *p, std::size_t n,
+                                               T *out, T init,
+                                               bool exclusive) noexcept {
+  std::size_t i = 0;
+  if constexpr (!std::is_same_v<V, T>) {
+    constexpr std::size_t width = sizeof(V) / sizeof(T);
+    V carry = V{} + init;
+    for (; i + width <= n; i += width) {
+      V x;
+      std::memcpy(&x, p + i, sizeof(x));
+      scanLanes(x);
+      // Off the dependency chain from one vector to the next, which is
+      // only the add to carry
+      const V total = V{} + x[width - 1];
+      x += carry;
+      if (exclusive) {
+        shiftUp<1>(carry, x);
+      }
+      std::memcpy(out + i, &x, sizeof(x));
+      carry += total;
+    }
+    init = carry[0];
+  }
+  for (; i < n; ++i) {
+    const T x = p[i];
+    out[i] = exclusive ? init : init + x;
+    init += x;
+  }
+  return init;
+}
+
+#if defined(TRY_RANGES_SIMD_X86) || defined(TRY_RANGES_SIMD_NEON)
+typedef std::uint32_t U32x4 __attribute__((vector_size(16)));
+typedef std::int64_t I64x2 __attribute__((vector_size(16)));
+typedef std::uint64_t U64x2 __attribute__((vector_size(16)));
+#endif
+
+#ifdef TRY_RANGES_SIMD_X86
+typedef std::uint32_t U32x8 __attribute__((vector_size(32)));
+typedef std::int64_t I64x4 __attribute__((vector_size(32)));
+typedef std::uint64_t U64x4 __attribute__((vector_size(32)));
+
+template <typename V, typename T>
+__attribute__((target("sse2"))) T prefixSumSse2(const T *p, std::size_t n,
+                                               T *out, T init,
+                                               bool exclusive) noexcept {
+  return prefixSumLanes<V>(p, n, out, init, exclusive);
+}
+
+template <typename V, typename T>
+__attribute__((target("avx2"))) T prefixSumAvx2(const T *p, std::size_t n,
+                                               T *out, T init,
+                                               bool exclusive) noexcept {
+  return prefixSumLanes<V>(p, n, out, init, exclusive);
+}
+#endif
+
+template <typename V16, typename V32, typename T>
+T prefixSumDispatch(const T *p, std::size_t n, T *out, T init,
+                    bool exclusive) noexcept {
+  switch (activeIsa()) {
+  case Isa::Scalar:
+    break;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return prefixSumSse2<V16>(p, n, out, init, exclusive);
+  case Isa::Avx2:
+    return prefixSumAvx2<V32>(p, n, out, init, exclusive);
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return prefixSumLanes<V16>(p, n, out, init, exclusive);
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return prefixSumLanes<T>(p, n, out, init, exclusive);
+}
+
+std::atomic<Isa> &activeIsaStorage() noexcept {
+  static std::atomic<Isa> isa{detectIsa()};
+  return isa;
+}
+} // namespace
+
+Isa detectIsa() noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return Isa::Avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return Isa::Sse2;
+  }
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return Isa::Neon;
+#endif
+  return Isa::Scalar;
+}
+
+bool isSupported(Isa isa) noexcept {
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return __builtin_cpu_supports("sse2");
+  case Isa::Avx2:
+    return __builtin_cpu_supports("avx2");
+  case Isa::Neon:
+    return false;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Sse2:
+  case Isa::Avx2:
+    return false;
+  case Isa::Neon:
+    return true;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    return false;
+#endif
+  }
+  return false;
+}
+
+std::string_view isaName(Isa isa) noexcept {
+  switch (isa) {
+  case Isa::Scalar:
+    return "scalar";
+  case Isa::Sse2:
+    return "sse2";
+  case Isa::Avx2:
+    return "avx2";
+  case Isa::Neon:
+    return "neon";
+  }
+  return "unknown";
+}
+
+Isa activeIsa() noexcept {
+  return activeIsaStorage().load(std::memory_order_relaxed);
+}
+
+void setActiveIsa(Isa isa) noexcept {
+  activeIsaStorage().store(isSupported(isa) ? isa : Isa::Scalar,
+                           std::memory_order_relaxed);
+}
+
+MatchMaskFn matchMask(Isa isa) noexcept {
+  switch (isSupported(isa) ? isa : Isa::Scalar) {
+  case Isa::Scalar:
+    return &matchMaskScalar;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return &matchMaskSse2;
+  case Isa::Avx2:
+    return &matchMaskAvx2;
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return &matchMaskNeon;
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return &matchMaskScalar;
+}
+
+MatchMaskFn matchMask() noexcept { return matchMask(activeIsa()); }
+
+RangeMaskFn rangeMask(Isa isa) noexcept {
+  switch (isSupported(isa) ? isa : Isa::Scalar) {
+  case Isa::Scalar:
+    return &rangeMaskScalar;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    return &rangeMaskSse2;
+  case Isa::Avx2:
+    return &rangeMaskAvx2;
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return &rangeMaskNeon;
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return &rangeMaskScalar;
+}
+
+RangeMaskFn rangeMask() noexcept { return rangeMask(activeIsa()); }
+
+std::size_t find(std::string_view s, char c, std::size_t pos) noexcept {
+  const MatchMaskFn mask = matchMask();
+  for (std::size_t base = pos; base < s.size(); base += BlockSize) {
+    const std::size_t n = std::min(BlockSize, s.size() - base);
+    if (const std::uint64_t m = detail::partialMask(
+            s.data() + base, n,
+            [mask, c](const char *block) { return mask(block, c); });
+        m != 0) {
+      return base + static_cast<std::size_t>(std::countr_zero(m));
+    }
+  }
+  return std::string_view::npos;
+}
+
+SetMaskFn setMask(Isa isa) noexcept {
+  switch (isSupported(isa) ? isa : Isa::Scalar) {
+  case Isa::Scalar:
+    return &setMaskScalar;
+#ifdef TRY_RANGES_SIMD_X86
+  case Isa::Sse2:
+    // The byte shuffle is SSSE3
+    return &setMaskScalar;
+  case Isa::Avx2:
+    return &setMaskAvx2;
+  case Isa::Neon:
+    break;
+#elif defined(TRY_RANGES_SIMD_NEON)
+  case Isa::Neon:
+    return &setMaskNeon;
+  case Isa::Sse2:
+  case Isa::Avx2:
+    break;
+#else
+  case Isa::Sse2:
+  case Isa::Avx2:
+  case Isa::Neon:
+    break;
+#endif
+  }
+  return &setMaskScalar;
+}
+
+SetMaskFn setMask() noexcept { return setMask(activeIsa()); }
+
+// Candidates are the positions where both the first and the last char of the
+// needle match, only those are compared in full
+std::size_t find(std::string_view s, std::string_view needle,
+                 std::size_t pos) noexcept {
+  if (needle.size() <= 1) {
+    if (needle.empty()) {
+      return pos <= s.size() ? pos : std::string_view::npos;
+    }
+    return find(s, needle.front(), pos);
+  }
+  if (s.size() < needle.size()) {
+    return std::string_view::npos;
+  }
+  const MatchMaskFn mask = matchMask();
+  const std::size_t last = needle.size() - 1;
+  const std::size_t stop = s.size() - last;
+  for (std::size_t base = pos; base < stop; base += BlockSize) {
+    const std::size_t n = std::min(BlockSize, stop - base);
+    std::uint64_t m =
+        detail::partialMask(s.data() + base, n,
+                            [mask, c = needle.front()](const char *block) {
+                              return mask(block, c);
+                            }) &
+        detail::partialMask(s.data() + base + last, n,
+                            [mask, c = needle.back()](const char *block) {
+                              return mask(block, c);
+                            });
+    for (; m != 0; m &= m - 1) {
+      const std::size_t i = base + static_cast<std::size_t>(std::countr_zero(m));
+      if (std::memcmp(s.data() + i + 1, needle.data() + 1, last - 1) == 0) {
+        return i;
+      }
+    }
+  }
+  return std::string_view::npos;
+}
+
+std::size_t findFirstOf(std::string_view s, const SetTable &set,
+                        std::size_t pos) noexcept {
+  const SetMaskFn mask = setMask();
+  for (std::size_t base = pos; base < s.size(); base += BlockSize) {
+    const std::size_t n = std::min(BlockSize, s.size() - base);
+    if (const std::uint64_t m = detail::partialMask(
+            s.data() + base, n,
+            [mask, &set](const char *block) { return mask(block, set); });
+        m != 0) {
+      return base + static_cast<std::size_t>(std::countr_zero(m));
+    }
+  }
+  return std::string_view::npos;
+}
+
+std::size_t count(std::string_view s, char c) noexcept {
+  std::size_t n = 0;
+  std::size_t base = 0;
+#ifdef TRY_RANGES_SIMD_X86
+  if (activeIsa() == Isa::Avx2) {
+    base = s.size() / BlockSize * BlockSize;
+    n = countAvx2(s.data(), base, c);
+  }
+#endif
+  const MatchMaskFn mask = matchMask();
+  for (; base < s.size(); base += BlockSize) {
+    n += static_cast<std::size_t>(std::popcount(detail::partialMask(
+        s.data() + base, std::min(BlockSize, s.size() - base),
+        [mask, c](const char *block) { return mask(block, c); })));
+  }
+  return n;
+}
+
+double sum(const double *p, std::size_t n, bool compensated) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return sumDispatch<double, F64x2, F64x4>(p, n, compensated);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return sumDispatch<double, F64x2, double>(p, n, compensated);
+#else
+  return sumDispatch<double, double, double>(p, n, compensated);
+#endif
+}
+
+float sum(const float *p, std::size_t n, bool compensated) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return sumDispatch<float, F32x4, F32x8>(p, n, compensated);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return sumDispatch<float, F32x4, float>(p, n, compensated);
+#else
+  return sumDispatch<float, float, float>(p, n, compensated);
+#endif
+}
+
+std::int32_t prefixSum(const std::int32_t *p, std::size_t n, std::int32_t *out,
+                       std::int32_t init, bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<I32x4, I32x8>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<I32x4, std::int32_t>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<std::int32_t, std::int32_t>(p, n, out, init,
+                                                       exclusive);
+#endif
+}
+
+std::uint32_t prefixSum(const std::uint32_t *p, std::size_t n,
+                        std::uint32_t *out, std::uint32_t init,
+                        bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<U32x4, U32x8>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<U32x4, std::uint32_t>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<std::uint32_t, std::uint32_t>(p, n, out, init,
+                                                         exclusive);
+#endif
+}
+
+std::int64_t prefixSum(const std::int64_t *p, std::size_t n, std::int64_t *out,
+                       std::int64_t init, bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<I64x2, I64x4>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<I64x2, std::int64_t>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<std::int64_t, std::int64_t>(p, n, out, init,
+                                                       exclusive);
+#endif
+}
+
+std::uint64_t prefixSum(const std::uint64_t *p, std::size_t n,
+                        std::uint64_t *out, std::uint64_t init,
+                        bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<U64x2, U64x4>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<U64x2, std::uint64_t>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<std::uint64_t, std::uint64_t>(p, n, out, init,
+                                                         exclusive);
+#endif
+}
+
+double prefixSum(const double *p, std::size_t n, double *out, double init,
+                 bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<F64x2, F64x4>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<F64x2, double>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<double, double>(p, n, out, init, exclusive);
+#endif
+}
+
+float prefixSum(const float *p, std::size_t n, float *out, float init,
+                bool exclusive) noexcept {
+#ifdef TRY_RANGES_SIMD_X86
+  return prefixSumDispatch<F32x4, F32x8>(p, n, out, init, exclusive);
+#elif defined(TRY_RANGES_SIMD_NEON)
+  return prefixSumDispatch<F32x4, float>(p, n, out, init, exclusive);
+#else
+  return prefixSumDispatch<float, float>(p, n, out, init, exclusive);
+#endif
+}
+
+std::size_t intersectSorted(const std::int32_t *a, std::size_t n,
+                            const std::int32_t *b, std::size_t m,
+                            std::int32_t *out) noexcept {
+  return matchDispatch(a, n, b, m, out, true);
+}
+
+std::size_t intersectSorted(const std::uint32_t *a, std::size_t n,
+                            const std::uint32_t *b, std::size_t m,
+                            std::uint32_t *out) noexcept {
+  return matchDispatch(a, n, b, m, out, true);
+}
+
+std::size_t differenceSorted(const std::int32_t *a, std::size_t n,
+                             const std::int32_t *b, std::size_t m,
+                             std::int32_t *out) noexcept {
+  return matchDispatch(a, n, b, m, out, false);
+}
+
+std::size_t differenceSorted(const std::uint32_t *a, std::size_t n,
+                             const std::uint32_t *b, std::size_t m,
+                             std::uint32_t *out) noexcept {
+  return matchDispatch(a, n, b, m, out, false);
+}
+
+} // namespace simd
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CharSet.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace simd {
+
+enum class Isa { Scalar, Sse2, Avx2, Neon };
+
+// Best instruction set usable on this CPU, detected once at first use.
+[[nodiscard]] Isa detectIsa() noexcept;
+[[nodiscard]] bool isSupported(Isa isa) noexcept;
+[[nodiscard]] std::string_view isaName(Isa isa) noexcept;
+
+// The kernels used by the dispatching helpers below. Defaults to detectIsa(),
+// tests and benchmarks may pin a specific (supported) one.
+[[nodiscard]] Isa activeIsa() noexcept;
+void setActiveIsa(Isa isa) noexcept;
+
+inline constexpr std::size_t BlockSize = 64;
+
+// Bit i of the result is set iff block[i] == c, block must have BlockSize
+// readable bytes
+using MatchMaskFn = std::uint64_t (*)(const char *block, char c) noexcept;
+
+[[nodiscard]] MatchMaskFn matchMask(Isa isa) noexcept;
+[[nodiscard]] MatchMaskFn matchMask() noexcept;
+
+// Bit i of the result is set iff lo <= block[i] <= hi as unsigned bytes
+using RangeMaskFn = std::uint64_t (*)(const char *block, char lo,
+                                      char hi) noexcept;
+
+[[nodiscard]] RangeMaskFn rangeMask(Isa isa) noexcept;
+[[nodiscard]] RangeMaskFn rangeMask() noexcept;
+
+// A CharSet as nibble lookup tables for the shuffle based kernels: byte
+// h * 16 + l is in the set iff bit h % 8 of (h < 8 ? low : high)[l] is set
+struct SetTable {
+  std::array<std::uint8_t, 16> low{};
+  std::array<std::uint8_t, 16> high{};
+
+  constexpr SetTable() = default;
+  constexpr explicit SetTable(const CharSet &set) noexcept {
+    for (unsigned c = 0; c < 256; ++c) {
+      if (set.contains(static_cast<char>(c))) {
+        auto &row = c < 128 ? low : high;
+        row[c % 16] = static_cast<std::uint8_t>(row[c % 16] | 1U << (c / 16 % 8));
+      }
+    }
+  }
+};
+
+// Bit i of the result is set iff block[i] is in the set
+using SetMaskFn = std::uint64_t (*)(const char *block,
+                                    const SetTable &set) noexcept;
+
+[[nodiscard]] SetMaskFn setMask(Isa isa) noexcept;
+[[nodiscard]] SetMaskFn setMask() noexcept;
+
+namespace detail {
+// blockMask(block) of the first n (<= BlockSize) bytes at p, without reading
+// past them
+template <typename BlockMask>
+[[nodiscard]] std::uint64_t partialMask(const char *p, std::size_t n,
+                                        BlockMask blockMask) noexcept {
+  if (n == BlockSize) {
+    return blockMask(p);
+  }
+  char block[BlockSize]{};
+  std::memcpy(block, p, n);
+  return blockMask(+block) & ((std::uint64_t{1} << n) - 1);
+}
+
+template <typename BlockMask, typename F>
+void forEachBit(std::string_view s, BlockMask blockMask, F &&f) {
+  for (std::size_t base = 0; base < s.size(); base += BlockSize) {
+    const std::size_t n = std::min(BlockSize, s.size() - base);
+    for (std::uint64_t m = partialMask(s.data() + base, n, blockMask); m != 0;
+         m &= m - 1) {
+      f(base + static_cast<std::size_t>(std::countr_zero(m)));
+    }
+  }
+}
+} // namespace detail
+
+// Calls f(pos) for every pos with s[pos] == c, in increasing order
+template <typename F> void forEachMatch(std::string_view s, char c, F &&f) {
+  const MatchMaskFn mask = matchMask();
+  detail::forEachBit(
+      s, [mask, c](const char *block) { return mask(block, c); }, f);
+}
+
+// Calls f(pos) for every pos with lo <= s[pos] <= hi, in increasing order
+template <typename F>
+void forEachInRange(std::string_view s, char lo, char hi, F &&f) {
+  const RangeMaskFn mask = rangeMask();
+  detail::forEachBit(
+      s, [mask, lo, hi](const char *block) { return mask(block, lo, hi); }, f);
+}
+
+// Position of the first c in s at or after pos, std::string_view::npos if none
+[[nodiscard]] std::size_t find(std::string_view s, char c,
+                               std::size_t pos = 0) noexcept;
+
+// Position of the first occurrence of needle in s at or after pos,
+// std::string_view::npos if none. An empty needle is found at pos.
+[[nodiscard]] std::size_t find(std::string_view s, std::string_view needle,
+                               std::size_t pos = 0) noexcept;
+
+// Position of the first char of s at or after pos that is in set,
+// std::string_view::npos if none
+[[nodiscard]] std::size_t findFirstOf(std::string_view s, const SetTable &set,
+                                      std::size_t pos = 0) noexcept;
+
+[[nodiscard]] std::size_t count(std::string_view s, char c) noexcept;
+
+// Sum of the n values at p, reassociated over independent vector lanes, so
+// it may differ from the sequential sum in the last bits. compensated runs a
+// Kahan summation in every lane, the lanes are always folded with one.
+[[nodiscard]] double sum(const double *p, std::size_t n,
+                         bool compensated = false) noexcept;
+[[nodiscard]] float sum(const float *p, std::size_t n,
+                        bool compensated = false) noexcept;
+
+// out[i] = init + p[0] + ... + p[i], the inclusive prefix sums of the n
+// values at p, or up to p[i - 1] if exclusive. out may be p. Returns init
+// plus all n. A vector of values is scanned in its register, by shifted
+// adds, then gets the total so far, so floating point sums are reassociated
+// within a vector and may differ from the sequential ones in the last bits.
+std::int32_t prefixSum(const std::int32_t *p, std::size_t n, std::int32_t *out,
+                       std::int32_t init, bool exclusive = false) noexcept;
+std::uint32_t prefixSum(const std::uint32_t *p, std::size_t n,
+                        std::uint32_t *out, std::uint32_t init,
+                        bool exclusive = false) noexcept;
+std::int64_t prefixSum(const std::int64_t *p, std::size_t n, std::int64_t *out,
+                       std::int64_t init, bool exclusive = false) noexcept;
+std::uint64_t prefixSum(const std::uint64_t *p, std::size_t n,
+                        std::uint64_t *out, std::uint64_t init,
+                        bool exclusive = false) noexcept;
+double prefixSum(const double *p, std::size_t n, double *out, double init,
+                 bool exclusive = false) noexcept;
+float prefixSum(const float *p, std::size_t n, float *out, float init,
+                bool exclusive = false) noexcept;
+
+// The values of the strictly increasing a[0, n) that are also in the
+// strictly increasing b[0, m), written to out in order. Returns how many,
+// out needs room for min(n, m). A block of a is compared with every value of
+// a block of b at once, the lower block moves on.
+std::size_t intersectSorted(const std::int32_t *a, std::size_t n,
+                            const std::int32_t *b, std::size_t m,
+                            std::int32_t *out) noexcept;
+std::size_t intersectSorted(const std::uint32_t *a, std::size_t n,
+                            const std::uint32_t *b, std::size_t m,
+                            std::uint32_t *out) noexcept;
+
+// Same for the values of a that are not in b, out needs room for n
+std::size_t differenceSorted(const std::int32_t *a, std::size_t n,
+                             const std::int32_t *b, std::size_t m,
+                             std::int32_t *out) noexcept;
+std::size_t differenceSorted(const std::uint32_t *a, std::size_t n,
+                             const std::uint32_t *b, std::size_t m,
+                             std::uint32_t *out) noexcept;
+
+} // namespace simd
@@ -0,0 +1,208 @@
+#include "Simd.hpp"
+#include "SimdTestSupport.hpp"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+std::string randomText(std::size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, 7);
+  std::string s(n, 'x');
+  for (auto &c : s) {
+    c = dist(gen) == 0 ? '\n' : static_cast<char>('a' + dist(gen));
+  }
+  return s;
+}
+} // namespace
+
+TEST_CASE("simd::matchMask") {
+  SUBCASE("detected isa is supported") {
+    CHECK_UNARY(simd::isSupported(simd::detectIsa()));
+    CHECK_UNARY(simd::isSupported(simd::Isa::Scalar));
+  }
+  SUBCASE("every supported kernel agrees with scalar") {
+    const auto s = randomText(simd::BlockSize * 64, 42);
+    const auto scalar = simd::matchMask(simd::Isa::Scalar);
+    for (const auto isa : AllIsas) {
+      if (!simd::isSupported(isa)) {
+        continue;
+      }
+      const auto mask = simd::matchMask(isa);
+      for (std::size_t i = 0; i + simd::BlockSize <= s.size(); i += 7) {
+        CHECK_EQ(mask(s.data() + i, '\n'), scalar(s.data() + i, '\n'));
+      }
+    }
+  }
+  SUBCASE("high bit bytes") {
+    std::array<char, simd::BlockSize> block{};
+    block[0] = '\xff';
+    block[63] = '\xff';
+    for (const auto isa : AllIsas) {
+      if (simd::isSupported(isa)) {
+        CHECK_EQ(simd::matchMask(isa)(block.data(), '\xff'),
+                 (std::uint64_t{1} << 63U) | 1U);
+      }
+    }
+  }
+}
+
+TEST_CASE("simd::rangeMask") {
+  std::array<char, simd::BlockSize * 4> bytes{};
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<char>(i);
+  }
+  const auto scalar = simd::rangeMask(simd::Isa::Scalar);
+  CHECK_EQ(scalar(bytes.data() + 64, 'A', 'Z'),
+           ((std::uint64_t{1} << 26U) - 1) << 1U);
+  for (const auto isa : AllIsas) {
+    if (!simd::isSupported(isa)) {
+      continue;
+    }
+    const auto mask = simd::rangeMask(isa);
+    for (std::size_t i = 0; i < bytes.size(); i += simd::BlockSize) {
+      for (const auto &[lo, hi] : {std::pair{'A', 'Z'}, std::pair{'\0', '\x7f'},
+                                  std::pair{'\x80', '\xff'},
+                                  std::pair{'x', 'x'}}) {
+        CHECK_EQ(mask(bytes.data() + i, lo, hi),
+                 scalar(bytes.data() + i, lo, hi));
+      }
+    }
+  }
+  SUBCASE("forEachInRange") {
+    std::vector<std::size_t> got;
+    simd::forEachInRange("aBcDe\0", 'A', 'Z',
+                         [&](std::size_t pos) { got.push_back(pos); });
+    CHECK_EQ(got, (std::vector<std::size_t>{1, 3}));
+  }
+}
+
+TEST_CASE("simd::forEachMatch, find and count") {
+  const auto s = randomText(1000, 7);
+  std::vector<std::size_t> expected;
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '\n') {
+      expected.push_back(i);
+    }
+  }
+  forEachIsa([&](simd::Isa) {
+    std::vector<std::size_t> got;
+    simd::forEachMatch(s, '\n', [&](std::size_t pos) { got.push_back(pos); });
+    CHECK_EQ(got, expected);
+    CHECK_EQ(simd::count(s, '\n'), expected.size());
+    CHECK_EQ(simd::find(s, '\n'), expected.front());
+    CHECK_EQ(simd::find(s, '\n', expected[3] + 1), expected[4]);
+    CHECK_EQ(simd::find(s, '\n', expected.back() + 1), std::string_view::npos);
+    CHECK_EQ(simd::find("", '\n'), std::string_view::npos);
+    CHECK_EQ(simd::count("", '\n'), 0);
+  });
+  SUBCASE("nul bytes past the end are not matched") {
+    const std::string_view t("ab\0", 2);
+    CHECK_EQ(simd::count(t, '\0'), 0);
+  }
+}
+
+TEST_CASE("simd::setMask") {
+  std::array<char, simd::BlockSize * 4> bytes{};
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<char>(i);
+  }
+  for (const auto &set : {CharSet(",;\t"), asciiSpace, CharSet("\x80\xff\x0f"),
+                          ~CharSet("a"), CharSet()}) {
+    const simd::SetTable table(set);
+    std::uint64_t expected = 0;
+    for (std::size_t i = 0; i < simd::BlockSize * 4; ++i) {
+      if (i % simd::BlockSize == 0) {
+        expected = 0;
+      }
+      expected |= std::uint64_t{set.contains(bytes[i])} << (i % simd::BlockSize);
+      if ((i + 1) % simd::BlockSize != 0) {
+        continue;
+      }
+      for (const auto isa : AllIsas) {
+        if (simd::isSupported(isa)) {
+          CHECK_EQ(simd::setMask(isa)(bytes.data() + i + 1 - simd::BlockSize,
+                                      table),
+                   expected);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("simd::find a string and findFirstOf") {
+  const auto s = randomText(1000, 11);
+  const simd::SetTable chars(CharSet("\nab"));
+  forEachIsa([&](simd::Isa) {
+    for (const std::string_view needle : {"a", "\na", "cab", "b\nba", "zzz"}) {
+      for (std::size_t pos = 0; pos <= s.size(); pos += 13) {
+        CHECK_EQ(simd::find(s, needle, pos), s.find(needle, pos));
+      }
+    }
+    for (std::size_t pos = 0; pos <= s.size(); pos += 13) {
+      CHECK_EQ(simd::findFirstOf(s, chars, pos), s.find_first_of("\nab", pos));
+    }
+    CHECK_EQ(simd::find("abc", "", 1), 1);
+    CHECK_EQ(simd::find("abc", "bcd"), std::string_view::npos);
+    CHECK_EQ(simd::findFirstOf("", chars), std::string_view::npos);
+  });
+  SUBCASE("does not read past the end") {
+    const std::string_view t("xab", 2);
+    CHECK_EQ(simd::find(t, "ab"), std::string_view::npos);
+    CHECK_EQ(simd::findFirstOf(std::string_view("xyb", 2), chars),
+             std::string_view::npos);
+  }
+}
+
+namespace {
+template <typename T> void checkPrefixSum() {
+  std::mt19937 gen(13);
+  std::uniform_int_distribution<int> dist(0, 100);
+  // Small integers, so that the float sums are exact in any order
+  const std::equal_to<T> eq;
+  std::vector<T> v(203);
+  for (auto &x : v) {
+    x = static_cast<T>(dist(gen));
+  }
+  for (const std::size_t n : {0U, 1U, 7U, 8U, 9U, 203U}) {
+    std::vector<T> inclusive(n);
+    std::vector<T> exclusive(n);
+    T sum = 5;
+    for (std::size_t i = 0; i < n; ++i) {
+      exclusive[i] = sum;
+      sum += v[i];
+      inclusive[i] = sum;
+    }
+    std::vector<T> out(n);
+    CHECK_UNARY(eq(simd::prefixSum(v.data(), n, out.data(), T{5}), sum));
+    CHECK_EQ(out, inclusive);
+    CHECK_UNARY(eq(simd::prefixSum(v.data(), n, out.data(), T{5}, true), sum));
+    CHECK_EQ(out, exclusive);
+    std::vector<T> inPlace(v.begin(),
+                           v.begin() + static_cast<std::ptrdiff_t>(n));
+    CHECK_UNARY(
+        eq(simd::prefixSum(inPlace.data(), n, inPlace.data(), T{5}, true),
+           sum));
+    CHECK_EQ(inPlace, exclusive);
+  }
+}
+} // namespace
+
+TEST_CASE("simd::prefixSum") {
+  forEachIsa([&](simd::Isa) {
+    checkPrefixSum<std::int32_t>();
+    checkPrefixSum<std::uint32_t>();
+    checkPrefixSum<std::int64_t>();
+    checkPrefixSum<std::uint64_t>();
+    checkPrefixSum<double>();
+    checkPrefixSum<float>();
+  });
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Simd.hpp"
+
+#include <array>
+
+// Test helpers for code with a kernel per instruction set
+
+inline constexpr std::array AllIsas = {simd::Isa::Scalar, simd::Isa::Sse2,
+                                       simd::Isa::Avx2, simd::Isa::Neon};
+
+// Restores the detected kernels when a test pinned another one
+struct IsaGuard {
+  IsaGuard() = default;
+  IsaGuard(const IsaGuard &) = delete;
+  IsaGuard &operator=(const IsaGuard &) = delete;
+  ~IsaGuard() { simd::setActiveIsa(simd::detectIsa()); }
+};
+
+// Calls f(isa) with the kernels of every isa this machine supports pinned in
+// turn, the detected ones again afterwards
+template <typename F> void forEachIsa(F f) {
+  const IsaGuard guard;
+  for (const auto isa : AllIsas) {
+    if (!simd::isSupported(isa)) {
+      continue;
+    }
+    simd::setActiveIsa(isa);
+    f(isa);
+  }
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <range/v3/functional/invoke.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/traits.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/interface.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Aggregates of every window of k consecutive elements, the positions of
+// rv::sliding(k), updated as the window moves instead of recomputed over
+// it: rng | sliding_sum(k) and sliding_mean(k) add the element that comes
+// into the window and subtract the one that leaves, sliding_min(k) and
+// sliding_max(k) keep a monotonic deque of the elements that can still be
+// the extreme of a window. O(1) per element, amortized for min and max.
+// They read the base range once, front to back, keeping at most k elements,
+// so they work over input ranges, e.g. a LineReader, and are input ranges
+// themselves. A range shorter than k has no windows.
+
+namespace detail {
+template <typename T>
+using slidingSumType =
+    std::remove_cvref_t<decltype(std::declval<T>() + std::declval<T>())>;
+
+// The sum of the last k elements pushed. Floating point sums are
+// compensated, Neumaier's variant of Kahan's, so that the rounding error of
+// every add and subtract doesn't pile up over a long series.
+template <typename T> class SumWindow {
+public:
+  using S = slidingSumType<T>;
+  using value_type = S;
+
+  void reset(std::size_t k) {
+    ring_.assign(k, T{});
+    pos_ = 0;
+    sum_ = S{};
+    c_ = S{};
+  }
+
+  // True once the window is full
+  bool push(const T &x, std::size_t count) {
+    if (count >= ring_.size()) {
+      add(-S(ring_[pos_]));
+    }
+    ring_[pos_] = x;
+    pos_ = pos_ + 1 == ring_.size() ? 0 : pos_ + 1;
+    add(S(x));
+    return count + 1 >= ring_.size();
+  }
+
+  [[nodiscard]] S value() const { return sum_ + c_; }
+  [[nodiscard]] std::size_t size() const noexcept { return ring_.size(); }
+
+private:
+  void add(const S &x) {
+    if constexpr (std::is_floating_point_v<S>) {
+      const S t = sum_ + x;
+      c_ += std::abs(sum_) >= std::abs(x) ? (sum_ - t) + x : (x - t) + sum_;
+      sum_ = t;
+    } else {
+      sum_ += x;
+    }
+  }
+
+  std::vector<T> ring_;
+  std::size_t pos_ = 0;
+  S sum_{};
+  S c_{};
+};
+
+// The mean of the last k elements, in double for integers
+template <typename T> class MeanWindow {
+  using S = slidingSumType<T>;
+
+public:
+  using value_type = std::conditional_t<std::is_floating_point_v<S>, S, double>;
+
+  void reset(std::size_t k) { sum_.reset(k); }
+  bool push(const T &x, std::size_t count) { return sum_.push(x, count); }
+
+  [[nodiscard]] value_type value() const {
+    if constexpr (std::is_floating_point_v<S>) {
+      return sum_.value() / static_cast<S>(sum_.size());
+    } else {
+      return static_cast<double>(sum_.value()) /
+             static_cast<double>(sum_.size());
+    }
+  }
+
+private:
+  SumWindow<T> sum_;
+};
+
+// The first of the last k elements that nothing in the window comes before
+// under comp, the minimum for std::less, as std::min_element. The deque
+// holds the elements, with their positions, that no later one comes before:
+// a new element drops those it comes before from the back, it is the
+// extreme of every window they are in with it, and the front drops out with
+// the window. It never holds more than k, in a ring of k entries.
+template <typename T, typename Comp> class ExtremeWindow {
+public:
+  using value_type = T;
+
+  ExtremeWindow() = default;
+  explicit ExtremeWindow(Comp comp) : comp_(std::move(comp)) {}
+
+  void reset(std::size_t k) {
+    ring_.assign(k, Entry{});
+    front_ = 0;
+    size_ = 0;
+  }
+
+  bool push(const T &x, std::size_t count) {
+    const std::size_t k = ring_.size();
+    while (size_ != 0 && ranges::invoke(comp_, x, at(size_ - 1).x)) {
+      --size_;
+    }
+    if (size_ != 0 && at(0).pos + k <= count) {
+      front_ = front_ + 1 == k ? 0 : front_ + 1;
+      --size_;
+    }
+    at(size_) = {x, count};
+    ++size_;
+    return count + 1 >= k;
+  }
+
+  [[nodiscard]] const T &value() const { return ring_[front_].x; }
+
+private:
+  struct Entry {
+    T x{};
+    std::size_t pos = 0;
+  };
+
+  Entry &at(std::size_t i) {
+    const std::size_t j = front_ + i;
+    return ring_[j < ring_.size() ? j : j - ring_.size()];
+  }
+
+  Comp comp_;
+  std::vector<Entry> ring_;
+  std::size_t front_ = 0;
+  std::size_t size_ = 0;
+};
+} // namespace detail
+
+// The value of Window, one of the windows above, at every window of k
+// elements of V
+template <typename V, typename Window>
+  requires ranges::input_range<V> && ranges::view_<V>
+class sliding_window_view
+    : public ranges::view_interface<sliding_window_view<V, Window>> {
+  using T = typename Window::value_type;
+
+public:
+  class iterator {
+  public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    iterator() = default;
+
+    const T &operator*() const { return value_; }
+    iterator &operator++() {
+      next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return it.done_;
+    }
+
+  private:
+    friend sliding_window_view;
+    explicit iterator(sliding_window_view &parent)
+        : parent_(&parent), it_(ranges::begin(parent.base_)) {
+      parent.window_.reset(parent.k_);
+      next();
+    }
+
+    void next() {
+      auto &p = *parent_;
+      while (*it_ != ranges::end(p.base_)) {
+        const bool full = p.window_.push(**it_, count_++);
+        ++*it_;
+        if (full) {
+          value_ = p.window_.value();
+          return;
+        }
+      }
+      done_ = true;
+    }
+
+    sliding_window_view *parent_ = nullptr;
+    std::optional<ranges::iterator_t<V>> it_;
+    std::size_t count_ = 0;
+    T value_{};
+    bool done_ = false;
+  };
+
+  sliding_window_view() = default;
+  sliding_window_view(V base, std::size_t k, Window window)
+      : base_(std::move(base)), k_(k), window_(std::move(window)) {
+    if (k == 0) {
+      throw std::invalid_argument("sliding: windows of no elements");
+    }
+  }
+
+  // Reads the base range from its begin again
+  [[nodiscard]] iterator begin() { return iterator(*this); }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  V base_;
+  std::size_t k_ = 1;
+  Window window_;
+};
+
+namespace detail {
+template <template <typename> typename Window> struct SlidingFn {
+  std::size_t k;
+
+  template <ranges::input_range R> auto operator()(R &&rng) const {
+    using T = std::remove_cvref_t<ranges::range_reference_t<R>>;
+    return sliding_window_view<ranges::views::all_t<R>, Window<T>>(
+        ranges::views::all(std::forward<R>(rng)), k, Window<T>{});
+  }
+  template <ranges::input_range R>
+  friend auto operator|(R &&rng, const SlidingFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+
+template <typename Comp> struct SlidingExtremeFn {
+  std::size_t k;
+  Comp comp;
+
+  template <ranges::input_range R> auto operator()(R &&rng) const {
+    using T = std::remove_cvref_t<ranges::range_reference_t<R>>;
+    using Window = ExtremeWindow<T, Comp>;
+    return sliding_window_view<ranges::views::all_t<R>, Window>(
+        ranges::views::all(std::forward<R>(rng)), k, Window(comp));
+  }
+  template <ranges::input_range R>
+  friend auto operator|(R &&rng, const SlidingExtremeFn &f) {
+    return f(std::forward<R>(rng));
+  }
+};
+
+// The maximum is the minimum under the flipped comparison
+template <typename Comp> struct Flipped {
+  Comp comp;
+  template <typename T> bool operator()(const T &a, const T &b) const {
+    return ranges::invoke(comp, b, a);
+  }
+};
+} // namespace detail
+
+// rng | sliding_sum(k), std::invalid_argument for k == 0
+[[nodiscard]] inline detail::SlidingFn<detail::SumWindow>
+sliding_sum(std::size_t k) {
+  return {k};
+}
+
+[[nodiscard]] inline detail::SlidingFn<detail::MeanWindow>
+sliding_mean(std::size_t k) {
+  return {k};
+}
+
+// rng | sliding_min(k, comp), the first of the minimal elements of every
+// window under comp
+template <typename Comp = std::less<>>
+[[nodiscard]] detail::SlidingExtremeFn<Comp> sliding_min(std::size_t k,
+                                                         Comp comp = {}) {
+  return {k, std::move(comp)};
+}
+
+// rng | sliding_max(k, comp), the first of the maximal elements
+template <typename Comp = std::less<>>
+[[nodiscard]] detail::SlidingExtremeFn<detail::Flipped<Comp>>
+sliding_max(std::size_t k, Comp comp = {}) {
+  return {k, {std::move(comp)}};
+}
@@ -0,0 +1,106 @@
+#include "Sliding.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/istream.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<int> randomInts(std::size_t n) {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> dist(-50, 50);
+  std::vector<int> v(n);
+  for (auto &x : v) {
+    x = dist(gen);
+  }
+  return v;
+}
+
+// f over every window of k elements of v, recomputed
+template <typename F>
+auto windows(const std::vector<int> &v, std::size_t k, F f) {
+  std::vector<decltype(f(v.begin(), v.begin()))> out;
+  for (std::size_t i = 0; i + k <= v.size(); ++i) {
+    const auto first = v.begin() + static_cast<std::ptrdiff_t>(i);
+    out.push_back(f(first, first + static_cast<std::ptrdiff_t>(k)));
+  }
+  return out;
+}
+} // namespace
+
+TEST_CASE("sliding_sum, sliding_mean, sliding_min and sliding_max") {
+  const auto v = randomInts(1000);
+  using It = std::vector<int>::const_iterator;
+  const auto sum = [](It f, It l) { return std::accumulate(f, l, 0); };
+  const auto min = [](It f, It l) { return *std::min_element(f, l); };
+  const auto max = [](It f, It l) { return *std::max_element(f, l); };
+
+  SUBCASE("the same as recomputing every window") {
+    for (const std::size_t k : {1U, 2U, 3U, 16U, 999U, 1000U}) {
+      CHECK_EQ(v | sliding_sum(k) | ranges::to<std::vector>(),
+               windows(v, k, sum));
+      CHECK_EQ(v | sliding_min(k) | ranges::to<std::vector>(),
+               windows(v, k, min));
+      CHECK_EQ(v | sliding_max(k) | ranges::to<std::vector>(),
+               windows(v, k, max));
+    }
+    const auto means = v | sliding_mean(4) | ranges::to<std::vector>();
+    const auto sums = windows(v, 4, sum);
+    REQUIRE_EQ(means.size(), sums.size());
+    for (std::size_t i = 0; i < sums.size(); ++i) {
+      CHECK_EQ(means[i], doctest::Approx(sums[i] / 4.0));
+    }
+  }
+
+  SUBCASE("comparators and ties") {
+    const std::vector<int> desc = {5, 4, 4, 3, 8, 8, 1};
+    const std::vector<int> mins = {4, 3, 3, 3, 1};
+    const std::vector<int> maxs = {5, 4, 8, 8, 8};
+    CHECK_EQ(desc | sliding_min(3) | ranges::to<std::vector>(), mins);
+    CHECK_EQ(desc | sliding_max(3) | ranges::to<std::vector>(), maxs);
+    CHECK_EQ(desc | sliding_min(3, std::greater<>()) |
+                 ranges::to<std::vector>(),
+             maxs);
+  }
+
+  SUBCASE("over an input range") {
+    std::istringstream in("1 2 3 4 5 6");
+    auto sums = ranges::istream_view<int>(in) | sliding_sum(3);
+    const std::vector<int> expected = {6, 9, 12, 15};
+    CHECK_EQ(sums | ranges::to<std::vector>(), expected);
+  }
+
+  SUBCASE("shorter than a window") {
+    const std::vector<int> two = {1, 2};
+    CHECK_UNARY((two | sliding_sum(3) | ranges::to<std::vector>()).empty());
+    CHECK_UNARY((two | sliding_max(3) | ranges::to<std::vector>()).empty());
+    CHECK_THROWS_AS(two | sliding_sum(0), std::invalid_argument);
+  }
+
+  SUBCASE("floating point sums don't drift") {
+    // A 1 added while a 1e16 is in the window is lost to rounding, unless
+    // it is compensated
+    std::vector<double> x(100000, 1.0);
+    for (std::size_t i = 0; i < x.size(); i += 100) {
+      x[i] = 1e16;
+    }
+    const auto sums = x | sliding_sum(10) | ranges::to<std::vector>();
+    CHECK_EQ(sums.back(), doctest::Approx(10.0).epsilon(1e-15));
+  }
+
+  SUBCASE("unsigned and narrow elements") {
+    const std::vector<std::uint8_t> bytes(10, 200);
+    const auto sums = bytes | sliding_sum(4) | ranges::to<std::vector>();
+    CHECK_EQ(sums.front(), 800);
+  }
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <range/v3/algorithm/sort.hpp>
+#include <range/v3/functional/comparisons.hpp>
+#include <range/v3/functional/identity.hpp>
+#include <range/v3/functional/invoke.hpp>
+#include <range/v3/range/access.hpp>
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/traits.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail {
+// Fewer elements than this are not worth the passes over the counts
+inline constexpr std::size_t radixMinSize = 256;
+// Parts of the MSD splits this small are insertion sorted
+inline constexpr std::size_t radixInsertionSize = 32;
+// About what fits in L2, the largest part sorted LSD
+inline constexpr std::size_t radixCacheBytes = std::size_t{1} << 19;
+
+template <typename T>
+concept radixKey = (std::integral<T> && !std::same_as<T, bool>) ||
+                   ((std::same_as<T, float> || std::same_as<T, double>) &&
+                    std::numeric_limits<T>::is_iec559);
+
+// Unsigned sort keys of at least 32 bits: flipping the sign bit orders
+// signed integers, flipping every bit of negatives and the sign bit of the
+// others orders IEEE floats, -0.0 before 0.0 and NaNs at either end
+template <radixKey T> [[nodiscard]] constexpr auto toRadix(T x) noexcept {
+  using K = std::conditional_t<sizeof(T) <= 4, std::uint32_t, std::uint64_t>;
+  constexpr K sign = K{1} << (std::numeric_limits<K>::digits - 1);
+  if constexpr (std::floating_point<T>) {
+    const K k = std::bit_cast<std::conditional_t<sizeof(T) == 4, std::uint32_t,
+                                                 std::uint64_t>>(x);
+    return (k & sign) != 0 ? ~k : k | sign;
+  } else if constexpr (std::signed_integral<T>) {
+    const std::make_signed_t<K> s = x;
+    return std::bit_cast<K>(s) ^ sign;
+  } else {
+    const K k = x;
+    return k;
+  }
+}
+
+template <radixKey T>
+[[nodiscard]] constexpr T fromRadix(decltype(toRadix(T{})) k) noexcept {
+  using K = decltype(k);
+  constexpr K sign = K{1} << (std::numeric_limits<K>::digits - 1);
+  if constexpr (std::floating_point<T>) {
+    return std::bit_cast<T>((k & sign) != 0 ? k ^ sign : ~k);
+  } else {
+    const K u = std::signed_integral<T> ? k ^ sign : k;
+    if constexpr (sizeof(T) == sizeof(K)) {
+      return std::bit_cast<T>(u);
+    } else {
+      return static_cast<T>(u);
+    }
+  }
+}
+
+// A key and where its element was
+template <typename K> struct KeyIndex {
+  K key;
+  std::uint32_t index;
+};
+
+template <typename K> [[nodiscard]] constexpr K radixOf(K k) noexcept {
+  return k;
+}
+template <typename K>
+[[nodiscard]] constexpr K radixOf(const KeyIndex<K> &e) noexcept {
+  return e.key;
+}
+
+// Stable radix sort of p[0, n) by the low digits bytes of radixOf, through
+// tmp of n elements. The counts of all of them are taken in one pass, a
+// byte that is the same for all keys costs no pass. Once the elements fit
+// in cache the rest are sorted LSD, a byte per pass from the lowest, before
+// that they are split by their highest byte that differs, MSD, so that the
+// scatters of the LSD passes stay in cache.
+template <typename E>
+void radixSort(E *p, E *tmp, std::size_t n, std::size_t digits) {
+  if (n <= radixInsertionSize) {
+    for (std::size_t i = 1; i < n; ++i) {
+      const E x = p[i];
+      std::size_t j = i;
+      for (; j > 0 && radixOf(x) < radixOf(p[j - 1]); --j) {
+        p[j] = p[j - 1];
+      }
+      p[j] = x;
+    }
+    return;
+  }
+  std::array<std::array<std::size_t, 256>, sizeof(radixOf(*p))> counts{};
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto k = radixOf(p[i]);
+#pragma GCC unroll 8
+    for (std::size_t d = 0; d < counts.size(); ++d) {
+      ++counts[d][static_cast<std::size_t>(k >> (8 * d) & 0xFFU)];
+    }
+  }
+  const auto digitOf = [](const E &e, std::size_t d) {
+    return static_cast<std::size_t>(radixOf(e) >> (8 * d) & 0xFFU);
+  };
+  // Exclusive prefix sums of counts[d], false if all keys have the same byte
+  const auto offsets = [&](std::size_t d) {
+    auto &c = counts[d];
+    if (c[digitOf(p[0], d)] == n) {
+      return false;
+    }
+    std::size_t sum = 0;
+    for (auto &x : c) {
+      sum += std::exchange(x, sum);
+    }
+    return true;
+  };
+  if (n * sizeof(E) > radixCacheBytes) {
+    for (std::size_t d = digits; d-- > 0;) {
+      if (!offsets(d)) {
+        continue;
+      }
+      std::array<std::size_t, 257> starts{};
+      std::copy(counts[d].begin(), counts[d].end(), starts.begin());
+      starts[256] = n;
+      auto &c = counts[d];
+      for (std::size_t i = 0; i < n; ++i) {
+        tmp[c[digitOf(p[i], d)]++] = p[i];
+      }
+      std::copy(tmp, tmp + n, p);
+      for (std::size_t b = 0; b < 256; ++b) {
+        if (const std::size_t m = starts[b + 1] - starts[b]; m > 1) {
+          radixSort(p + starts[b], tmp + starts[b], m, d);
+        }
+      }
+      return;
+    }
+    return;
+  }
+  E *from = p;
+  E *to = tmp;
+  for (std::size_t d = 0; d < digits; ++d) {
+    if (!offsets(d)) {
+      continue;
+    }
+    auto &c = counts[d];
+    for (std::size_t i = 0; i < n; ++i) {
+      to[c[digitOf(from[i], d)]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != p) {
+    std::copy(from, from + n, p);
+  }
+}
+
+template <typename E> void radixSort(E *p, E *tmp, std::size_t n) {
+  radixSort(p, tmp, n, sizeof(radixOf(*p)));
+}
+
+// Moves first[perm[i]] to first[i] for every i, following the cycles of
+// perm, so every element moves once and a cycle needs one temporary. perm
+// is used up.
+template <typename I>
+void applyPermutation(I first, std::uint32_t *perm, std::size_t n) {
+  const auto at = [first](std::size_t i) {
+    return first + static_cast<std::iter_difference_t<I>>(i);
+  };
+  for (std::size_t i = 0; i < n; ++i) {
+    if (perm[i] == i) {
+      continue;
+    }
+    auto tmp = ranges::iter_move(at(i));
+    std::size_t j = i;
+    while (perm[j] != i) {
+      const std::size_t k = perm[j];
+      *at(j) = ranges::iter_move(at(k));
+      perm[j] = static_cast<std::uint32_t>(j);
+      j = k;
+    }
+    *at(j) = std::move(tmp);
+    perm[j] = static_cast<std::uint32_t>(j);
+  }
+}
+
+template <typename Comp>
+inline constexpr bool isLess =
+    std::is_same_v<Comp, ranges::less> || std::is_same_v<Comp, std::less<>>;
+template <typename Comp>
+inline constexpr bool isGreater = std::is_same_v<Comp, ranges::greater> ||
+                                  std::is_same_v<Comp, std::greater<>>;
+} // namespace detail
+
+// rg::sort(rng, comp, proj), radix sorted when the projected keys are
+// integers, float or double and comp is less or greater: the keys are taken
+// once, with the index of their element, radix sorted, then the elements
+// moved to their places, each exactly once. So neither comparisons nor
+// projections run per comparison, and a large element, a struct with a
+// string say, moves once instead of O(log n) times. A range of the keys
+// themselves is sorted as keys only. Elements with equal keys keep their
+// order then, but as with rg::sort, that is not promised.
+//
+// Anything else, small ranges and ranges of more than 2^32 elements go to
+// rg::sort.
+template <typename R, typename Comp = ranges::less,
+          typename Proj = ranges::identity>
+  requires ranges::random_access_range<R> && ranges::sized_range<R>
+void fast_sort(R &&rng, Comp comp = {}, Proj proj = {}) {
+  using Key = std::remove_cvref_t<
+      std::invoke_result_t<Proj &, ranges::range_reference_t<R>>>;
+  const auto n = static_cast<std::size_t>(ranges::size(rng));
+  if constexpr (detail::radixKey<Key> &&
+                (detail::isLess<Comp> || detail::isGreater<Comp>)) {
+    if (n >= detail::radixMinSize &&
+        n <= std::numeric_limits<std::uint32_t>::max()) {
+      const auto first = ranges::begin(rng);
+      const auto at = [first](std::size_t i) {
+        return first + static_cast<ranges::range_difference_t<R>>(i);
+      };
+      using K = decltype(detail::toRadix(Key{}));
+      // Descending is ascending by the complement
+      const auto key = [&](std::size_t i) {
+        const Key k = ranges::invoke(proj, *at(i));
+        return detail::isLess<Comp> ? detail::toRadix(k)
+                                    : ~detail::toRadix(k);
+      };
+      if constexpr (std::is_same_v<Proj, ranges::identity> &&
+                    std::is_same_v<ranges::range_value_t<R>, Key>) {
+        const auto keys = std::make_unique_for_overwrite<K[]>(2 * n);
+        for (std::size_t i = 0; i < n; ++i) {
+          keys[i] = key(i);
+        }
+        detail::radixSort(keys.get(), keys.get() + n, n);
+        for (std::size_t i = 0; i < n; ++i) {
+          *at(i) = detail::fromRadix<Key>(detail::isLess<Comp> ? keys[i]
+                                                               : ~keys[i]);
+        }
+      } else {
+        auto items =
+            std::make_unique_for_overwrite<detail::KeyIndex<K>[]>(2 * n);
+        for (std::size_t i = 0; i < n; ++i) {
+          items[i] = {key(i), static_cast<std::uint32_t>(i)};
+        }
+        detail::radixSort(items.get(), items.get() + n, n);
+        std::vector<std::uint32_t> perm(n);
+        for (std::size_t i = 0; i < n; ++i) {
+          perm[i] = items[i].index;
+        }
+        items.reset();
+        detail::applyPermutation(first, perm.data(), n);
+      }
+      return;
+    }
+  }
+  ranges::sort(rng, std::move(comp), std::move(proj));
+}
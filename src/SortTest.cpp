@@ -0,0 +1,138 @@
+#include "Sort.hpp"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+struct Elem {
+  std::string name;
+  double density;
+};
+
+template <typename T> std::vector<T> randomValues(std::size_t n) {
+  std::mt19937_64 gen(n);
+  std::vector<T> v(n);
+  for (auto &x : v) {
+    if constexpr (std::is_floating_point_v<T>) {
+      x = std::uniform_real_distribution<T>(-1e6, 1e6)(gen);
+    } else {
+      x = static_cast<T>(gen());
+    }
+  }
+  return v;
+}
+
+// fast_sort against std::sort, on lengths below radixMinSize, sorted in
+// cache and split MSD first
+template <typename T, typename Comp = std::less<>>
+void checkKeys(Comp comp = {}) {
+  for (const std::size_t n : {0U, 1U, 100U, 256U, 1000U, 300000U}) {
+    auto v = randomValues<T>(n);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end(), comp);
+    fast_sort(v, comp);
+    CHECK_EQ(v, expected);
+  }
+}
+
+std::vector<Elem> makeElems(std::size_t n) {
+  std::mt19937 gen(42);
+  // Few distinct densities, to have ties
+  std::uniform_int_distribution<int> density(-50, 50);
+  std::vector<Elem> v(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v[i] = {"E" + std::to_string(i), density(gen) / 4.0};
+  }
+  return v;
+}
+
+// Sorted by density, and the same elements as before
+void checkElems(const std::vector<Elem> &before, const std::vector<Elem> &after,
+                bool descending) {
+  REQUIRE_EQ(after.size(), before.size());
+  CHECK_UNARY(std::is_sorted(
+      after.begin(), after.end(), [&](const Elem &a, const Elem &b) {
+        return descending ? b.density < a.density : a.density < b.density;
+      }));
+  std::vector<std::string> x;
+  std::vector<std::string> y;
+  for (std::size_t i = 0; i < before.size(); ++i) {
+    x.push_back(before[i].name + "/" + std::to_string(before[i].density));
+    y.push_back(after[i].name + "/" + std::to_string(after[i].density));
+  }
+  std::sort(x.begin(), x.end());
+  std::sort(y.begin(), y.end());
+  CHECK_EQ(x, y);
+}
+} // namespace
+
+TEST_CASE("fast_sort") {
+  SUBCASE("integer keys of every width and signedness") {
+    checkKeys<std::int8_t>();
+    checkKeys<std::uint16_t>();
+    checkKeys<int>();
+    checkKeys<unsigned>();
+    checkKeys<std::int64_t>();
+    checkKeys<std::uint64_t>();
+    checkKeys<int>(std::greater<>());
+    checkKeys<std::int64_t>(ranges::greater());
+  }
+
+  SUBCASE("floating point keys") {
+    checkKeys<float>();
+    checkKeys<double>();
+    checkKeys<double>(std::greater<>());
+
+    auto v = randomValues<double>(1000);
+    v[1] = -0.0;
+    v[2] = std::numeric_limits<double>::infinity();
+    v[3] = -std::numeric_limits<double>::infinity();
+    v[4] = std::numeric_limits<double>::denorm_min();
+    v[5] = -std::numeric_limits<double>::denorm_min();
+    v[6] = 0.0;
+    fast_sort(v);
+    CHECK_UNARY(std::is_sorted(v.begin(), v.end()));
+    CHECK_UNARY(std::isinf(v.front()) && v.front() < 0);
+    CHECK_UNARY(std::isinf(v.back()) && v.back() > 0);
+    const auto zero = std::find(v.begin(), v.end(), 0.0);
+    REQUIRE_NE(zero, v.end());
+    CHECK_UNARY(std::signbit(*zero));
+  }
+
+  SUBCASE("projected member, moving whole elements") {
+    for (const std::size_t n : {10U, 5000U, 100000U}) {
+      const auto before = makeElems(n);
+      auto v = before;
+      fast_sort(v, ranges::less(), &Elem::density);
+      checkElems(before, v, false);
+      v = before;
+      fast_sort(v, ranges::greater(), &Elem::density);
+      checkElems(before, v, true);
+      v = before;
+      fast_sort(v, ranges::less(),
+                [](const Elem &e) { return static_cast<int>(e.density * 4); });
+      checkElems(before, v, false);
+    }
+  }
+
+  SUBCASE("other keys and comparisons are compared") {
+    auto v = makeElems(1000);
+    fast_sort(v, ranges::less(), &Elem::name);
+    CHECK_UNARY(std::is_sorted(v.begin(), v.end(),
+                               [](const Elem &a, const Elem &b) {
+                                 return a.name < b.name;
+                               }));
+    auto w = randomValues<int>(1000);
+    const auto byLastDigit = [](int a, int b) { return a % 10 < b % 10; };
+    fast_sort(w, byLastDigit);
+    CHECK_UNARY(std::is_sorted(w.begin(), w.end(), byLastDigit));
+  }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Test helpers for code reading files
+
+// A fresh path in the temp directory. ctest runs every test case as a
+// process of its own, often several at once, so the names carry a random
+// number per process as well as a counter.
+inline std::filesystem::path uniqueTempPath(std::string_view prefix) {
+  static const auto process = std::random_device{}();
+  static unsigned n = 0;
+  return std::filesystem::temp_directory_path() /
+         (std::string(prefix) + std::to_string(process) + "-" +
+          std::to_string(n++));
+}
+
+// Temporary file removed again at scope exit
+class TempFile {
+public:
+  explicit TempFile(std::string_view content)
+      : path_(uniqueTempPath("try-ranges-") += ".txt") {
+    std::ofstream(path_, std::ios::binary) << content;
+  }
+  TempFile(const TempFile &) = delete;
+  TempFile &operator=(const TempFile &) = delete;
+  ~TempFile() {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+  [[nodiscard]] const std::filesystem::path &path() const { return path_; }
+
+private:
+  std::filesystem::path path_;
+};
+
+// A scratch directory removed again at scope exit
+class TempDir {
+public:
+  TempDir() : path_(uniqueTempPath("try-ranges-dir-")) {
+    std::filesystem::create_directories(path_);
+  }
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+  [[nodiscard]] const std::filesystem::path &path() const { return path_; }
+  // Writes name in the directory, replacing what was there
+  std::filesystem::path write(const std::string &name,
+                              std::string_view content) const {
+    const auto p = path_ / name;
+    std::ofstream(p, std::ios::binary) << content;
+    return p;
+  }
+
+private:
+  std::filesystem::path path_;
+};
@@ -0,0 +1,256 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+#ifdef __linux__
+std::vector<int> allowedCpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return {};
+  }
+  std::vector<int> cpus;
+  for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+// A sysfs cpulist like "0-3,8-11", restricted to the allowed CPUs
+std::vector<int> parseCpuList(std::string_view list,
+                              const std::vector<int> &allowed) {
+  std::vector<int> cpus;
+  constexpr std::string_view space = " \t\r\n";
+  const auto from = std::min(list.find_first_not_of(space), list.size());
+  list = list.substr(from, list.find_last_not_of(space) + 1 - from);
+  for (std::size_t pos = 0; pos < list.size();) {
+    const auto comma = std::min(list.find(',', pos), list.size());
+    const auto range = list.substr(pos, comma - pos);
+    pos = comma + 1;
+    int first = 0;
+    int last = 0;
+    const auto dash = range.find('-');
+    const auto end = range.data() + range.size();
+    if (std::from_chars(range.data(), end, first).ec != std::errc{}) {
+      continue;
+    }
+    last = first;
+    if (dash != std::string_view::npos &&
+        std::from_chars(range.data() + dash + 1, end, last).ec != std::errc{}) {
+      continue;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+// The allowed CPUs of every NUMA node that has some, empty if sysfs does not
+// list the nodes
+std::vector<std::vector<int>> numaNodes(const std::vector<int> &allowed) {
+  namespace fs = std::filesystem;
+  std::vector<std::vector<int>> nodes;
+  std::error_code ec;
+  for (fs::directory_iterator it("/sys/devices/system/node", ec), end;
+       !ec && it != end; it.increment(ec)) {
+    const std::string name = it->path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4) {
+      continue;
+    }
+    std::ifstream in(it->path() / "cpulist");
+    std::string list;
+    std::getline(in, list);
+    if (auto cpus = parseCpuList(list, allowed); !cpus.empty()) {
+      nodes.push_back(std::move(cpus));
+    }
+  }
+  return nodes;
+}
+
+// The CPUs each of n workers may run on, empty for anywhere
+std::vector<std::vector<int>> placement(std::size_t n, Pinning pinning) {
+  std::vector<std::vector<int>> cpus(n);
+  if (pinning == Pinning::None) {
+    return cpus;
+  }
+  const auto allowed = allowedCpus();
+  if (allowed.empty()) {
+    return cpus;
+  }
+  if (pinning == Pinning::NumaNodes) {
+    if (const auto nodes = numaNodes(allowed); !nodes.empty()) {
+      for (std::size_t i = 0; i < n; ++i) {
+        cpus[i] = nodes[i % nodes.size()];
+      }
+      return cpus;
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    cpus[i] = {allowed[i % allowed.size()]};
+  }
+  return cpus;
+}
+
+// Best effort, a worker that cannot be pinned runs unpinned
+void pinCurrentThread(const std::vector<int> &cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const int cpu : cpus) {
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#else
+std::vector<std::vector<int>> placement(std::size_t n, Pinning) {
+  return std::vector<std::vector<int>>(n);
+}
+
+void pinCurrentThread(const std::vector<int> &) {}
+#endif
+
+// Per thread xorshift, to spread the thieves over their victims
+std::size_t randomVictim(std::size_t n) {
+  thread_local std::uint64_t x =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1U;
+  x ^= x << 13U;
+  x ^= x >> 7U;
+  x ^= x << 17U;
+  return x % n;
+}
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads, Pinning pinning) {
+  threads = threads == 0 ? 1 : threads;
+  // Every deque exists before any worker may try to steal from it
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  auto cpus = placement(threads, pinning);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers_[i]->thread = std::thread(
+        [this, i, c = std::move(cpus[i])] {
+          pinCurrentThread(c);
+          work(i);
+        });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  stopping_.store(true);
+  epoch_.fetch_add(1);
+  epoch_.notify_all();
+  for (auto &w : workers_) {
+    w->thread.join();
+  }
+}
+
+ThreadPool &ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::post(std::function<void()> task) {
+  auto t = std::make_unique<Task>(std::move(task));
+  if (currentPool == this) {
+    workers_[currentWorker]->deque.push(t.release());
+  } else {
+    const std::lock_guard lock(mutex_);
+    injected_.push_back(std::move(t));
+  }
+  wake();
+}
+
+bool ThreadPool::tryRunOne() {
+  const auto task = next(currentPool == this ? currentWorker : workers_.size());
+  if (!task) {
+    return false;
+  }
+  (*task)();
+  return true;
+}
+
+// A sleeper either reads the epoch before a post bumps it, then the post
+// sees it in sleepers_ and wakes it, or after, then it also sees the task
+void ThreadPool::wake() {
+  epoch_.fetch_add(1);
+  if (sleepers_.load() != 0) {
+    epoch_.notify_one();
+  }
+}
+
+std::unique_ptr<ThreadPool::Task> ThreadPool::next(std::size_t worker) {
+  if (worker < workers_.size()) {
+    if (const auto t = workers_[worker]->deque.pop()) {
+      return std::unique_ptr<Task>(*t);
+    }
+  }
+  {
+    const std::lock_guard lock(mutex_);
+    if (!injected_.empty()) {
+      auto t = std::move(injected_.front());
+      injected_.pop_front();
+      return t;
+    }
+  }
+  const std::size_t n = workers_.size();
+  const std::size_t start = randomVictim(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::size_t victim = (start + i) % n;
+    if (victim == worker) {
+      continue;
+    }
+    if (const auto t = workers_[victim]->deque.steal()) {
+      return std::unique_ptr<Task>(*t);
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::work(std::size_t index) {
+  currentPool = this;
+  currentWorker = index;
+  for (;;) {
+    if (const auto task = next(index)) {
+      (*task)();
+      continue;
+    }
+    sleepers_.fetch_add(1);
+    const auto epoch = epoch_.load();
+    if (const auto task = next(index)) {
+      sleepers_.fetch_sub(1);
+      (*task)();
+      continue;
+    }
+    if (stopping_.load()) {
+      sleepers_.fetch_sub(1);
+      return;
+    }
+    epoch_.wait(epoch);
+    sleepers_.fetch_sub(1);
+  }
+}
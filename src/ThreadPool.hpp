@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Executor.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Where the workers of a ThreadPool may run
+enum class Pinning {
+  // Wherever the OS schedules them
+  None,
+  // Worker i on the i-th CPU the process may use, round robin
+  Cpus,
+  // Workers spread round robin over the NUMA nodes, each free to move among
+  // the CPUs of its node, so the memory it first touches stays local. Same
+  // as Cpus where the node layout is unknown.
+  NumaNodes,
+};
+
+// Work stealing pool: every worker has its own lock free deque. Tasks that a
+// worker posts go to its deque and it runs them newest first, other threads
+// post to a shared queue. An idle worker takes from that queue, then steals
+// the oldest task of another worker.
+//
+// Meant to be the one executor of a process, see shared(), so that parallel
+// utilities running at the same time share its threads instead of each
+// starting their own.
+class ThreadPool final : public Executor {
+public:
+  explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency(),
+                      Pinning pinning = Pinning::None);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+  // Runs the tasks still queued, then joins the workers
+  ~ThreadPool() override;
+
+  // A pool of hardware_concurrency() workers, started at first use
+  [[nodiscard]] static ThreadPool &shared();
+
+  void post(std::function<void()> task) override;
+  bool tryRunOne() override;
+  [[nodiscard]] std::size_t concurrency() const noexcept override {
+    return workers_.size();
+  }
+
+private:
+  using Task = std::function<void()>;
+
+  struct Worker {
+    WorkStealingDeque<Task *> deque;
+    std::thread thread;
+  };
+
+  void work(std::size_t index);
+  // The task a thread should run next, worker is its index or
+  // workers_.size() for a thread outside the pool
+  std::unique_ptr<Task> next(std::size_t worker);
+  void wake();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::mutex mutex_;
+  std::deque<std::unique_ptr<Task>> injected_;
+  std::atomic<bool> stopping_{false};
+  // Bumped on every post, idle workers wait for it to change
+  std::atomic<std::uint64_t> epoch_{0};
+  std::atomic<std::size_t> sleepers_{0};
+};
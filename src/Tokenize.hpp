@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CharSet.hpp"
+
+#include <range/v3/view/interface.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+// The maximal runs of word chars in a string, as std::string_view into it.
+// A regex free replacement for views::tokenize with [\w]+, which also is a
+// forward and common range, so the std algorithms accept it.
+class word_tokens : public ranges::view_interface<word_tokens> {
+public:
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::string_view operator*() const {
+      return s_.substr(first_, last_ - first_);
+    }
+    iterator &operator++() {
+      seek(last_);
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) {
+      return a.first_ == b.first_;
+    }
+
+  private:
+    friend word_tokens;
+    iterator(std::string_view s, const CharSet &word, std::size_t pos)
+        : s_(s), word_(word) {
+      seek(pos);
+    }
+
+    void seek(std::size_t pos) {
+      first_ = std::min(word_.findIn(s_, pos), s_.size());
+      last_ = std::min(word_.findNotIn(s_, first_), s_.size());
+    }
+
+    std::string_view s_;
+    CharSet word_;
+    std::size_t first_ = 0;
+    std::size_t last_ = 0;
+  };
+
+  word_tokens() = default;
+  explicit constexpr word_tokens(std::string_view s,
+                                 const CharSet &word = asciiWord) noexcept
+      : s_(s), word_(word) {}
+
+  // Tokens are the runs between delimiters instead, e.g. fields of a line
+  // with "," as delimiters. Empty fields are skipped.
+  [[nodiscard]] static constexpr word_tokens
+  delimitedBy(std::string_view s, const CharSet &delimiters) noexcept {
+    return word_tokens(s, ~delimiters);
+  }
+
+  [[nodiscard]] iterator begin() const { return {s_, word_, 0}; }
+  [[nodiscard]] iterator end() const { return {s_, word_, s_.size()}; }
+
+private:
+  std::string_view s_;
+  CharSet word_ = asciiWord;
+};
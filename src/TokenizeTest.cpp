@@ -0,0 +1,52 @@
+#include "Tokenize.hpp"
+
+#include <doctest/doctest.h>
+
+#include <range/v3/range/concepts.hpp>
+#include <range/v3/range/conversion.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+static_assert(ranges::forward_range<word_tokens>);
+static_assert(ranges::common_range<word_tokens>);
+
+TEST_CASE("word_tokens") {
+  using Tokens = std::vector<std::string_view>;
+  const auto tokens = [](auto rng) { return ranges::to<Tokens>(rng); };
+
+  SUBCASE("replaces views::tokenize with [\\w]+") {
+    CHECK_EQ(tokens(word_tokens("Have a nice   day!")),
+             (Tokens{"Have", "a", "nice", "day"}));
+  }
+  SUBCASE("no tokens") {
+    CHECK_UNARY(word_tokens("").empty());
+    CHECK_UNARY(word_tokens("  !? ").empty());
+  }
+  SUBCASE("tokens at both ends") {
+    CHECK_EQ(tokens(word_tokens("a_1 b")), (Tokens{"a_1", "b"}));
+  }
+  SUBCASE("custom word set") {
+    CHECK_EQ(tokens(word_tokens("1.5e3, -2", CharSet("0123456789.e-"))),
+             (Tokens{"1.5e3", "-2"}));
+  }
+  SUBCASE("delimiter set") {
+    CHECK_EQ(tokens(word_tokens::delimitedBy("a b,c;;d", CharSet(",;"))),
+             (Tokens{"a b", "c", "d"}));
+  }
+  SUBCASE("points into the input") {
+    const auto s = "ab cd"sv;
+    CHECK_EQ((*++word_tokens(s).begin()).data(), s.data() + 3);
+  }
+  SUBCASE("std algorithms") {
+    const word_tokens words("Have a nice   day!");
+    const auto chars = std::accumulate(
+        words.begin(), words.end(), std::size_t{0},
+        [](std::size_t n, std::string_view w) { return n + w.size(); });
+    CHECK_EQ(chars, 12);
+    CHECK_EQ(std::distance(words.begin(), words.end()), 4);
+  }
+}
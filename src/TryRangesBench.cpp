@@ -0,0 +1,374 @@
+#include "Bench.hpp"
+#include "CaseConvert.hpp"
+#include "Cipher.hpp"
+#include "Generator.hpp"
+#include "Sort.hpp"
+#include "Tokenize.hpp"
+#include "Utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <range/v3/all.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <random>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace rg = ranges;
+namespace rv = ranges::views;
+
+// The pipelines of TryRangesTest.cpp next to hand-written loops doing the same
+
+namespace {
+std::string randomLower(std::mt19937 &gen, std::size_t n) {
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::string s(n, 'a');
+  for (auto &c : s) {
+    c = static_cast<char>(letter(gen));
+  }
+  return s;
+}
+
+// trim_str
+
+inline constexpr auto trim_front = rv::drop_while(::isspace);
+inline constexpr auto trim_back = rv::reverse | trim_front | rv::reverse;
+inline constexpr auto trim_pipeline = trim_front | trim_back;
+std::string trim_str(std::string_view s) {
+  return s | trim_pipeline | rg::to<std::string>();
+}
+
+std::string makePaddedLines(std::size_t size) {
+  return bench::makeLines(size, [](std::mt19937 &gen) {
+    std::uniform_int_distribution<std::size_t> pad(0, 8);
+    std::uniform_int_distribution<std::size_t> len(0, 80);
+    return std::string(pad(gen), ' ') + std::string(len(gen), 'x') +
+           std::string(pad(gen), ' ');
+  });
+}
+
+template <typename Trim> void BM_trim(benchmark::State &state, Trim trimLine) {
+  const auto s = makePaddedLines(bench::inputSize(state));
+  const auto lines = splitLines(s);
+  for (auto _ : state) {
+    for (const auto line : lines) {
+      benchmark::DoNotOptimize(trimLine(line));
+    }
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto trimPipeline = [](std::string_view s) { return trim_str(s); };
+const auto trimUtils = [](std::string_view s) { return trim(s); };
+
+// snake_case to CamelCase
+
+std::string snakeToCamelPipeline(std::string_view s) {
+  auto words = s | rv::split('_');
+  auto words_cap = words | rv::transform([](auto w) {
+                     auto head = w | rv::take(1) | rv::transform([](int c) {
+                                   return std::toupper(c);
+                                 });
+                     return rv::concat(head, w | rv::tail);
+                   });
+  return words_cap | rv::join | rg::to<std::string>();
+}
+
+std::string snakeToCamelLoop(std::string_view s) {
+  std::string out;
+  out.reserve(s.size());
+  bool upper = true;
+  for (const char c : s) {
+    if (c == '_') {
+      upper = true;
+      continue;
+    }
+    out.push_back(upper ? static_cast<char>(
+                              std::toupper(static_cast<unsigned char>(c)))
+                        : c);
+    upper = false;
+  }
+  return out;
+}
+
+template <typename Convert>
+void BM_snakeToCamel(benchmark::State &state, Convert convert) {
+  const auto s = bench::makeLines(bench::inputSize(state), [](std::mt19937 &gen) {
+    std::uniform_int_distribution<std::size_t> words(1, 5);
+    std::uniform_int_distribution<std::size_t> len(2, 8);
+    std::string id = randomLower(gen, len(gen));
+    for (auto n = words(gen); n > 1; --n) {
+      id += '_' + randomLower(gen, len(gen));
+    }
+    return id;
+  });
+  const auto ids = splitLines(s);
+  for (auto _ : state) {
+    for (const auto id : ids) {
+      benchmark::DoNotOptimize(convert(id));
+    }
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto snakeToCamelPipelineFn = [](std::string_view s) {
+  return snakeToCamelPipeline(s);
+};
+const auto snakeToCamelLoopFn = [](std::string_view s) {
+  return snakeToCamelLoop(s);
+};
+// Reuses one output string, as a batch conversion would
+const auto snakeToCamelUtilsFn = [](std::string_view s) {
+  static std::string out;
+  snakeToCamel(s, out);
+  return out.size();
+};
+
+// Caesar cipher
+
+constexpr int CaesarShift = 11;
+
+std::string caesarPipeline(const std::string &s) {
+  auto alphabet = rv::closed_iota('a', 'z') | rv::cycle;
+  auto shifted_alphabet = alphabet | rv::drop(CaesarShift);
+  auto encrypted = s | rv::for_each([shifted_alphabet](char c) {
+                     return shifted_alphabet | rv::drop(c - 'a') | rv::take(1);
+                   });
+  return encrypted | rg::to<std::string>();
+}
+
+std::string caesarLoop(const std::string &s) {
+  std::string out(s.size(), '\0');
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    out[i] = static_cast<char>('a' + (s[i] - 'a' + CaesarShift) % 26);
+  }
+  return out;
+}
+
+template <typename Encrypt>
+void BM_caesar(benchmark::State &state, Encrypt encrypt) {
+  std::mt19937 gen(42);
+  const auto s = randomLower(gen, bench::inputSize(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encrypt(s));
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto caesarPipelineFn = [](const std::string &s) {
+  return caesarPipeline(s);
+};
+const auto caesarLoopFn = [](const std::string &s) { return caesarLoop(s); };
+const auto caesarCipherFn = [](const std::string &s) {
+  static constexpr auto cipher = SubstitutionCipher::caesar(CaesarShift);
+  return cipher.encode(s);
+};
+
+// set_union, set_intersection, set_difference
+
+using Set = std::vector<int>;
+
+// Multiples of 2 and of 3, together size bytes
+std::pair<Set, Set> makeSets(std::size_t size) {
+  const std::size_t n = size / sizeof(int) / 2;
+  Set a(n);
+  Set b(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    a[i] = static_cast<int>(2 * i);
+    b[i] = static_cast<int>(3 * i);
+  }
+  return {std::move(a), std::move(b)};
+}
+
+template <typename Op> void BM_setOp(benchmark::State &state, Op op) {
+  const auto [a, b] = makeSets(bench::inputSize(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(a, b));
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto setUnionView = [](const Set &a, const Set &b) {
+  return rv::set_union(a, b) | rg::to<Set>();
+};
+const auto setUnionStd = [](const Set &a, const Set &b) {
+  Set out;
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                 std::back_inserter(out));
+  return out;
+};
+const auto setIntersectionView = [](const Set &a, const Set &b) {
+  return rv::set_intersection(a, b) | rg::to<Set>();
+};
+const auto setIntersectionStd = [](const Set &a, const Set &b) {
+  Set out;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(out));
+  return out;
+};
+const auto setDifferenceView = [](const Set &a, const Set &b) {
+  return rv::set_difference(a, b) | rg::to<Set>();
+};
+const auto setDifferenceStd = [](const Set &a, const Set &b) {
+  Set out;
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::back_inserter(out));
+  return out;
+};
+
+// views::tokenize with [\w]+
+
+std::string makeSentences(std::size_t size) {
+  return bench::makeLines(size, [](std::mt19937 &gen) {
+    std::uniform_int_distribution<std::size_t> words(1, 12);
+    std::uniform_int_distribution<std::size_t> len(1, 10);
+    std::string line = randomLower(gen, len(gen));
+    for (auto n = words(gen); n > 1; --n) {
+      line += (n % 4 == 0 ? ", " : " ") + randomLower(gen, len(gen));
+    }
+    return line + '.';
+  });
+}
+
+template <typename Tokenize>
+void BM_tokenize(benchmark::State &state, Tokenize tokenize) {
+  const auto s = makeSentences(bench::inputSize(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tokenize(s));
+  }
+  bench::setBytesProcessed(state);
+}
+
+// Both return the total length of the tokens
+const auto tokenizeRegex = [](const std::string &s) {
+  static const std::regex word{"[\\w]+"};
+  std::size_t chars = 0;
+  for (std::sregex_token_iterator it(s.begin(), s.end(), word), end;
+       it != end; ++it) {
+    chars += static_cast<std::size_t>(it->length());
+  }
+  return chars;
+};
+const auto tokenizeWordTokens = [](const std::string &s) {
+  std::size_t chars = 0;
+  for (const auto token : word_tokens(s)) {
+    chars += token.size();
+  }
+  return chars;
+};
+
+// sort with projection
+
+struct Elem {
+  std::string name;
+  double density;
+};
+
+std::vector<Elem> makeElems(std::size_t size) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> density(0.1, 25.0);
+  std::vector<Elem> v(size / sizeof(Elem));
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    v[i] = {"E" + std::to_string(i), density(gen)};
+  }
+  return v;
+}
+
+// Copying the input is part of every iteration, it costs the same for both
+template <typename Sort> void BM_sort(benchmark::State &state, Sort sort) {
+  const auto input = makeElems(bench::inputSize(state));
+  for (auto _ : state) {
+    auto v = input;
+    sort(v);
+    benchmark::DoNotOptimize(v.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto sortProjection = [](std::vector<Elem> &v) {
+  rg::sort(v, rg::less(), &Elem::density);
+};
+const auto sortLambda = [](std::vector<Elem> &v) {
+  std::sort(v.begin(), v.end(), [](const Elem &a, const Elem &b) {
+    return a.density < b.density;
+  });
+};
+const auto sortFast = [](std::vector<Elem> &v) {
+  fast_sort(v, rg::less(), &Elem::density);
+};
+
+// "triangles 2" up to c = maxC, a pass over all the triangles per iteration
+template <typename Triangles>
+void BM_triangles(benchmark::State &state, Triangles triangles) {
+  const auto maxC = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    for (auto &&t : triangles(maxC)) {
+      benchmark::DoNotOptimize(&t);
+    }
+  }
+}
+
+const auto trianglesForEach = [](int maxC) {
+  return rv::closed_iota(1, maxC) | rv::for_each([](int c) {
+           return rv::closed_iota(1, c) | rv::for_each([c](int b) {
+                    return rv::closed_iota(1, b) | rv::for_each([c, b](int a) {
+                             return rg::yield_if(a * a + b * b == c * c,
+                                                 std::make_tuple(a, b, c));
+                           });
+                  });
+         });
+};
+const auto trianglesGenerator =
+    [](int maxC) -> generator<std::tuple<int, int, int>> {
+  for (int c = 1; c <= maxC; ++c) {
+    for (int b = 1; b <= c; ++b) {
+      for (int a = 1; a <= b; ++a) {
+        if (a * a + b * b == c * c) {
+          co_yield {a, b, c};
+        }
+      }
+    }
+  }
+};
+} // namespace
+
+BENCHMARK_CAPTURE(BM_trim, pipeline, trimPipeline)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_trim, utils, trimUtils)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_snakeToCamel, pipeline, snakeToCamelPipelineFn)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_snakeToCamel, loop, snakeToCamelLoopFn)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_snakeToCamel, utils, snakeToCamelUtilsFn)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_caesar, pipeline, caesarPipelineFn)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_caesar, loop, caesarLoopFn)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_caesar, cipher, caesarCipherFn)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, union_view, setUnionView)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, union_std, setUnionStd)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_view, setIntersectionView)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, intersection_std, setIntersectionStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_view, setDifferenceView)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_setOp, difference_std, setDifferenceStd)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_tokenize, regex, tokenizeRegex)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_tokenize, word_tokens, tokenizeWordTokens)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_sort, projection, sortProjection)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_sort, lambda, sortLambda)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_sort, fast, sortFast)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_triangles, for_each, trianglesForEach)->Arg(100)->Arg(300);
+BENCHMARK_CAPTURE(BM_triangles, generator, trianglesGenerator)
+    ->Arg(100)
+    ->Arg(300);
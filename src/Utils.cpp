@@ -1,19 +1,101 @@
 #include "Utils.hpp"
 
+#include "Executor.hpp"
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+// Writes the lines of s to out, returns how many were written. Throws
+// std::length_error if they do not fit.
+std::size_t fillLines(std::string_view s, std::span<std::string_view> out) {
+  std::size_t n = 0;
+  const auto emit = [&](std::string_view line) {
+    if (n == out.size()) {
+      throw std::length_error("splitLinesInto: output holds fewer lines "
+                              "than countLines");
+    }
+    out[n++] = line;
+  };
+  std::size_t prev = 0;
+  simd::forEachMatch(s, '\n', [&](std::size_t curr) {
+    emit(s.substr(prev, curr - prev));
+    prev = curr + 1;
+  });
+  if (prev != s.size()) {
+    emit(s.substr(prev));
+  }
+  return n;
+}
+} // namespace
+
+std::size_t countLines(std::string_view s) {
+  return simd::count(s, '\n') + (!s.empty() && s.back() != '\n' ? 1 : 0);
+}
+
 std::vector<std::string_view> splitLines(std::string_view s) {
   std::vector<std::string_view> v;
-  using sty = std::decay_t<decltype(s)>;
-  using ssty = decltype(s)::size_type;
-  ssty prev = 0;
-  while (prev != s.size()) {
-    const ssty curr = s.find_first_of('\n', prev);
-    if (curr != sty::npos) {
-      v.emplace_back(&s[prev], curr - prev);
-      prev = curr + 1;
-    } else {
-      v.emplace_back(&s[prev], s.size() - prev);
-      break;
-    }
+  v.reserve(countLines(s));
+  std::size_t prev = 0;
+  simd::forEachMatch(s, '\n', [&](std::size_t curr) {
+    v.emplace_back(s.data() + prev, curr - prev);
+    prev = curr + 1;
+  });
+  if (prev != s.size()) {
+    v.emplace_back(s.data() + prev, s.size() - prev);
   }
   return v;
 }
+
+std::span<std::string_view> splitLinesInto(std::string_view s,
+                                           std::span<std::string_view> out) {
+  return out.first(fillLines(s, out));
+}
+
+void splitLinesInto(std::string_view s, std::vector<std::string_view> &out) {
+  out.resize(countLines(s));
+  fillLines(s, out);
+}
+
+std::vector<std::string_view> splitLines(const MappedFile &f) {
+  return splitLines(f.view());
+}
+
+std::vector<std::string_view> splitLinesParallel(std::string_view s,
+                                                 Executor &ex,
+                                                 std::size_t minSegmentSize) {
+  const std::size_t segments =
+      std::min(ex.concurrency(), s.size() / std::max<std::size_t>(minSegmentSize, 1));
+  if (segments <= 1) {
+    return splitLines(s);
+  }
+
+  // Every segment but the last ends right after a '\n', so no line straddles
+  // two segments and their lines concatenate to the serial result
+  std::vector<std::size_t> cuts;
+  cuts.reserve(segments + 1);
+  cuts.push_back(0);
+  for (std::size_t i = 1; i < segments; ++i) {
+    const std::size_t nominal = std::max(cuts.back(), s.size() / segments * i);
+    const std::size_t eol = simd::find(s, '\n', nominal);
+    cuts.push_back(eol == std::string_view::npos ? s.size() : eol + 1);
+  }
+  cuts.push_back(s.size());
+  const auto segment = [&](std::size_t i) {
+    return s.substr(cuts[i], cuts[i + 1] - cuts[i]);
+  };
+
+  std::vector<std::size_t> offsets(segments + 1, 0);
+  parallelFor(ex, segments, [&](std::size_t i) {
+    offsets[i + 1] = countLines(segment(i));
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  std::vector<std::string_view> v(offsets.back());
+  parallelFor(ex, segments, [&](std::size_t i) {
+    fillLines(segment(i), std::span(v).subspan(offsets[i]));
+  });
+  return v;
+}
@@ -1,6 +1,247 @@
 #pragma once
 
+#include "CharSet.hpp"
+#include "MappedFile.hpp"
+#include "Simd.hpp"
+
+#include <range/v3/view/interface.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <stdexcept>
 #include <string_view>
 #include <vector>
 
 std::vector<std::string_view> splitLines(std::string_view s);
+
+// Number of lines splitLines(s) returns, counted without splitting
+std::size_t countLines(std::string_view s);
+// Writes the lines of s to the front of out and returns that part. out must
+// hold countLines(s) lines, std::length_error is thrown otherwise.
+std::span<std::string_view> splitLinesInto(std::string_view s,
+                                           std::span<std::string_view> out);
+// Replaces the content of out with the lines of s, allocates only when out
+// has less than countLines(s) capacity
+void splitLinesInto(std::string_view s, std::vector<std::string_view> &out);
+// The lines point into the mapping and are valid as long as f is
+std::vector<std::string_view> splitLines(const MappedFile &f);
+
+class Executor;
+
+// Same result as splitLines, the buffer is cut into newline aligned segments
+// of at least minSegmentSize bytes that are split concurrently
+std::vector<std::string_view>
+splitLinesParallel(std::string_view s, Executor &ex,
+                   std::size_t minSegmentSize = std::size_t{1} << 20U);
+
+// Lazily yields the same lines as splitLines, without materializing them.
+// Not sized, counting lines is a full scan.
+class lines_view : public ranges::view_interface<lines_view> {
+public:
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::string_view operator*() const {
+      return s_.substr(pos_, eol_ - pos_);
+    }
+    iterator &operator++() {
+      pos_ = eol_ < s_.size() ? eol_ + 1 : s_.size();
+      eol_ = findEol();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) {
+      return a.pos_ == b.pos_;
+    }
+
+  private:
+    friend lines_view;
+    iterator(std::string_view s, std::size_t pos)
+        : s_(s), pos_(pos), eol_(findEol()) {}
+
+    [[nodiscard]] std::size_t findEol() const {
+      const auto eol = simd::find(s_, '\n', pos_);
+      return eol == std::string_view::npos ? s_.size() : eol;
+    }
+
+    std::string_view s_;
+    std::size_t pos_ = 0;
+    std::size_t eol_ = 0;
+  };
+
+  lines_view() = default;
+  explicit lines_view(std::string_view s) : s_(s) {}
+
+  [[nodiscard]] iterator begin() const { return {s_, 0}; }
+  [[nodiscard]] iterator end() const { return {s_, s_.size()}; }
+
+private:
+  std::string_view s_;
+};
+
+// Splits s at every delimiter like views::split, but the pieces are
+// std::string_view into s. Adjacent delimiters, or one at either end, give
+// empty pieces, "" has none. The delimiter is a char, a non empty string or a
+// CharSet, all searched a block at a time by the simd kernels.
+class split_sv_view : public ranges::view_interface<split_sv_view> {
+public:
+  class Delimiter {
+  public:
+    constexpr Delimiter(char c) noexcept : kind_(Kind::Char), c_(c) {}
+    Delimiter(const CharSet &set) noexcept : kind_(Kind::Set), set_(set) {}
+    // Not copied, str must outlive the view
+    Delimiter(std::string_view str) : kind_(Kind::String), str_(str) {
+      if (str.empty()) {
+        throw std::invalid_argument("split_sv: empty delimiter");
+      }
+    }
+    Delimiter(const char *str) : Delimiter(std::string_view(str)) {}
+
+    [[nodiscard]] std::size_t size() const noexcept {
+      return kind_ == Kind::String ? str_.size() : 1;
+    }
+    // Position of the first delimiter in s at or after pos, s.size() if none
+    [[nodiscard]] std::size_t find(std::string_view s,
+                                   std::size_t pos) const noexcept {
+      std::size_t at = std::string_view::npos;
+      switch (kind_) {
+      case Kind::Char:
+        at = simd::find(s, c_, pos);
+        break;
+      case Kind::String:
+        at = simd::find(s, str_, pos);
+        break;
+      case Kind::Set:
+        at = simd::findFirstOf(s, set_, pos);
+        break;
+      }
+      return at == std::string_view::npos ? s.size() : at;
+    }
+
+  private:
+    enum class Kind : unsigned char { Char, String, Set };
+    Kind kind_;
+    char c_ = '\0';
+    std::string_view str_;
+    simd::SetTable set_;
+  };
+
+  class iterator {
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+
+    std::string_view operator*() const {
+      return s_.substr(pos_, end_ - pos_);
+    }
+    iterator &operator++() {
+      pos_ = end_ == s_.size() ? s_.size() + 1 : end_ + delim_.size();
+      end_ = findEnd();
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    friend bool operator==(const iterator &a, const iterator &b) {
+      return a.pos_ == b.pos_;
+    }
+
+  private:
+    friend split_sv_view;
+    // pos_ is one past s_.size() at the end, as the last piece may be an
+    // empty one at s_.size()
+    iterator(std::string_view s, const Delimiter &delim, std::size_t pos)
+        : s_(s), delim_(delim), pos_(pos), end_(findEnd()) {}
+
+    [[nodiscard]] std::size_t findEnd() const {
+      return pos_ > s_.size() ? pos_ : delim_.find(s_, pos_);
+    }
+
+    std::string_view s_;
+    Delimiter delim_ = '\n';
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+  };
+
+  split_sv_view() = default;
+  split_sv_view(std::string_view s, const Delimiter &delim)
+      : s_(s), delim_(delim) {}
+
+  [[nodiscard]] iterator begin() const {
+    return {s_, delim_, s_.empty() ? 1U : 0U};
+  }
+  [[nodiscard]] iterator end() const { return {s_, delim_, s_.size() + 1}; }
+
+private:
+  std::string_view s_;
+  Delimiter delim_ = '\n';
+};
+
+namespace detail {
+struct SplitSvClosure {
+  split_sv_view::Delimiter delim;
+
+  split_sv_view operator()(std::string_view s) const { return {s, delim}; }
+  friend split_sv_view operator|(std::string_view s, const SplitSvClosure &f) {
+    return f(s);
+  }
+};
+} // namespace detail
+
+// split_sv(s, delim), or s | split_sv(delim). The closure is also a function
+// of the string, so lines | rv::transform(split_sv(',')), for const auto
+// lines = splitLines(s), splits every line without copying.
+inline constexpr struct {
+  split_sv_view operator()(std::string_view s,
+                           const split_sv_view::Delimiter &delim) const {
+    return {s, delim};
+  }
+  detail::SplitSvClosure
+  operator()(const split_sv_view::Delimiter &delim) const {
+    return {delim};
+  }
+} split_sv;
+
+// Strip leading and/or trailing chars of ws, ASCII whitespace by default.
+// The result points into s.
+[[nodiscard]] constexpr std::string_view
+trimFront(std::string_view s, const CharSet &ws = asciiSpace) noexcept {
+  const auto first = ws.findNotIn(s);
+  return first == std::string_view::npos ? s.substr(s.size())
+                                         : s.substr(first);
+}
+[[nodiscard]] constexpr std::string_view
+trimBack(std::string_view s, const CharSet &ws = asciiSpace) noexcept {
+  auto n = s.size();
+  while (n != 0 && ws.contains(s[n - 1])) {
+    --n;
+  }
+  return s.substr(0, n);
+}
+[[nodiscard]] constexpr std::string_view
+trim(std::string_view s, const CharSet &ws = asciiSpace) noexcept {
+  return trimBack(trimFront(s, ws), ws);
+}
+
+// Trims every line of a range of std::string_view, e.g. lines | trimmed
+// for const auto lines = splitLines(s)
+inline constexpr auto trimmed =
+    ranges::views::transform([](std::string_view s) { return trim(s); });
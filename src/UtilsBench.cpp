@@ -0,0 +1,221 @@
+#include "Arena.hpp"
+#include "Bench.hpp"
+#include "BitPack.hpp"
+#include "CacheAll.hpp"
+#include "DigitSet.hpp"
+#include "Simd.hpp"
+#include "Utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <range/v3/algorithm/count_if.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// The find_first_of loop splitLines used before the SIMD scanner
+std::vector<std::string_view> splitLinesFindFirstOf(std::string_view s) {
+  std::vector<std::string_view> v;
+  std::size_t prev = 0;
+  while (prev != s.size()) {
+    const std::size_t curr = s.find_first_of('\n', prev);
+    if (curr != std::string_view::npos) {
+      v.emplace_back(&s[prev], curr - prev);
+      prev = curr + 1;
+    } else {
+      v.emplace_back(&s[prev], s.size() - prev);
+      break;
+    }
+  }
+  return v;
+}
+
+void BM_splitLinesFindFirstOf(benchmark::State &state) {
+  const auto s = bench::makeLines(bench::inputSize(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(splitLinesFindFirstOf(s));
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_splitLines(benchmark::State &state, simd::Isa isa) {
+  if (!simd::isSupported(isa)) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  simd::setActiveIsa(isa);
+  const auto s = bench::makeLines(bench::inputSize(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(splitLines(s));
+  }
+  bench::setBytesProcessed(state);
+  simd::setActiveIsa(simd::detectIsa());
+}
+
+// A buffer reused across inputs, as when splitting many files in a row
+void BM_splitLinesIntoReused(benchmark::State &state) {
+  const auto s = bench::makeLines(bench::inputSize(state));
+  std::vector<std::string_view> lines;
+  for (auto _ : state) {
+    splitLinesInto(s, lines);
+    benchmark::DoNotOptimize(lines.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+// The lines copied into strings, a batch per iteration
+void BM_copyLinesHeap(benchmark::State &state) {
+  const auto s = bench::makeLines(bench::inputSize(state));
+  const auto lines = splitLines(s);
+  for (auto _ : state) {
+    std::vector<std::string> copies;
+    copies.reserve(lines.size());
+    for (const auto line : lines) {
+      copies.emplace_back(line);
+    }
+    benchmark::DoNotOptimize(copies.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_copyLinesArena(benchmark::State &state) {
+  const auto s = bench::makeLines(bench::inputSize(state));
+  const auto lines = splitLines(s);
+  Arena arena;
+  for (auto _ : state) {
+    {
+      const auto copies =
+          to_pmr<std::pmr::vector<std::pmr::string>>(lines, arena);
+      benchmark::DoNotOptimize(copies.data());
+    }
+    arena.reset();
+  }
+  bench::setBytesProcessed(state);
+}
+
+// A transform worth caching, read three times: the largest element, the
+// sum, then how many are above the mean
+double norm(double x) {
+  double y = x;
+  for (int i = 0; i < 8; ++i) {
+    y = std::sqrt(y * y + x);
+  }
+  return y;
+}
+
+template <typename Cache>
+void BM_transformThreePasses(benchmark::State &state, Cache cache) {
+  std::vector<double> v(bench::inputSize(state) / sizeof(double));
+  std::mt19937 gen(42);
+  std::generate(v.begin(), v.end(), [&] {
+    return std::uniform_real_distribution<double>(0, 100)(gen);
+  });
+  for (auto _ : state) {
+    auto norms = cache(v | ranges::views::transform(norm));
+    double max = 0;
+    double sum = 0;
+    for (const double x : norms) {
+      max = std::max(max, x);
+    }
+    for (const double x : norms) {
+      sum += x;
+    }
+    const double mean = sum / static_cast<double>(v.size());
+    benchmark::DoNotOptimize(max);
+    benchmark::DoNotOptimize(
+        ranges::count_if(norms, [mean](double x) { return x > mean; }));
+  }
+  bench::setBytesProcessed(state);
+}
+
+const auto uncached = [](auto rng) { return rng; };
+const auto cached = [](auto rng) { return std::move(rng) | cache_all; };
+
+std::vector<std::uint8_t> randomFlags(std::size_t n) {
+  std::mt19937 gen(n);
+  std::vector<std::uint8_t> v(n);
+  for (auto &b : v) {
+    b = static_cast<std::uint8_t>(gen() & 1U);
+  }
+  return v;
+}
+
+// One shift and or per flag, what the compiler makes of the obvious loop
+void BM_packBitsLoop(benchmark::State &state) {
+  const auto v = randomFlags(bench::inputSize(state));
+  std::vector<std::uint64_t> words(packedWords(v.size()));
+  for (auto _ : state) {
+    std::fill(words.begin(), words.end(), 0);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      words[i / 64] |= std::uint64_t{v[i] != 0} << (i % 64);
+    }
+    benchmark::DoNotOptimize(words.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+void BM_packBits(benchmark::State &state) {
+  const auto v = randomFlags(bench::inputSize(state));
+  std::vector<std::uint64_t> words(packedWords(v.size()));
+  for (auto _ : state) {
+    packBits(v, words);
+    benchmark::DoNotOptimize(words.data());
+  }
+  bench::setBytesProcessed(state);
+}
+
+// The "All-digit magic" test over [1, 10^6): i and i * i written with every
+// digit but 0, as strings sorted and uniqued, then as digit sets
+constexpr long magicLast = 1000000;
+
+void BM_allDigitMagicStrings(benchmark::State &state) {
+  for (auto _ : state) {
+    long found = 0;
+    for (long i = 1; i < magicLast; ++i) {
+      std::string s = std::to_string(i) + std::to_string(i * i);
+      std::sort(s.begin(), s.end());
+      s.erase(std::unique(s.begin(), s.end()), s.end());
+      found += s.size() == 9 && s.find('0') == std::string::npos ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(found);
+  }
+}
+
+void BM_allDigitMagicDigitSet(benchmark::State &state) {
+  for (auto _ : state) {
+    long found = 0;
+    for (long i = 1; i < magicLast; ++i) {
+      found += (DigitSet::of(i) | DigitSet::of(i * i)) == nonZeroDigits ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(found);
+  }
+}
+} // namespace
+
+BENCHMARK(BM_splitLinesFindFirstOf)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_splitLines, scalar, simd::Isa::Scalar)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_splitLines, sse2, simd::Isa::Sse2)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_splitLines, avx2, simd::Isa::Avx2)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_splitLines, neon, simd::Isa::Neon)
+    ->Apply(bench::inputSizes);
+BENCHMARK(BM_splitLinesIntoReused)->Apply(bench::inputSizes);
+BENCHMARK(BM_copyLinesHeap)->Apply(bench::inputSizes);
+BENCHMARK(BM_copyLinesArena)->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_transformThreePasses, transform, uncached)
+    ->Apply(bench::inputSizes);
+BENCHMARK_CAPTURE(BM_transformThreePasses, cache_all, cached)
+    ->Apply(bench::inputSizes);
+BENCHMARK(BM_packBitsLoop)->Apply(bench::inputSizes);
+BENCHMARK(BM_packBits)->Apply(bench::inputSizes);
+BENCHMARK(BM_allDigitMagicStrings);
+BENCHMARK(BM_allDigitMagicDigitSet);
@@ -1,7 +1,21 @@
+#include "LinesTestSupport.hpp"
+#include "ThreadPool.hpp"
 #include "Utils.hpp"
 
 #include <doctest/doctest.h>
 
+#include <range/v3/algorithm/count_if.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+using namespace std::literals;
+
 TEST_CASE("splitLines") {
   SUBCASE("empty input yields one empty line") {
     const auto lines = splitLines("");
@@ -62,3 +76,199 @@ TEST_CASE("splitLines") {
   }
 }
 
+TEST_CASE("splitLines across block boundaries") {
+  const auto reference = [](std::string_view s) {
+    std::vector<std::string_view> v;
+    std::size_t prev = 0;
+    while (prev != s.size()) {
+      const auto curr = s.find_first_of('\n', prev);
+      if (curr == std::string_view::npos) {
+        v.emplace_back(&s[prev], s.size() - prev);
+        break;
+      }
+      v.emplace_back(&s[prev], curr - prev);
+      prev = curr + 1;
+    }
+    return v;
+  };
+  std::string s;
+  for (std::size_t len = 0; s.size() < 1000; len = (len + 13) % 97) {
+    s.append(len, 'x');
+    s.push_back('\n');
+  }
+  for (std::size_t n = 0; n <= s.size(); n += 31) {
+    const auto sub = std::string_view(s).substr(0, n);
+    CHECK_EQ(splitLines(sub), reference(sub));
+  }
+}
+
+TEST_CASE("lines_view") {
+  namespace rg = ranges;
+  namespace rv = ranges::views;
+  const auto same_as_splitLines = [](std::string_view s) {
+    return rg::to<std::vector<std::string_view>>(lines_view(s)) ==
+           splitLines(s);
+  };
+  SUBCASE("splits like splitLines") {
+    for (const auto s : edgeCases) {
+      CHECK_UNARY(same_as_splitLines(s));
+    }
+  }
+  SUBCASE("pipes into views and algorithms") {
+    const auto s = "apple\n\nbanana\nkiwi\n"sv;
+    auto sizes = lines_view(s) |
+                 rv::filter([](std::string_view l) { return !l.empty(); }) |
+                 rv::transform([](std::string_view l) { return l.size(); }) |
+                 rg::to<std::vector<std::size_t>>();
+    CHECK_EQ(sizes, (std::vector<std::size_t>{5, 6, 4}));
+    CHECK_EQ(rg::count_if(lines_view(s),
+                          [](std::string_view l) { return l.empty(); }),
+             1);
+  }
+  SUBCASE("multi-pass") {
+    const lines_view lines("a\nb"sv);
+    auto it = lines.begin();
+    const auto first = it++;
+    CHECK_EQ(*first, "a");
+    CHECK_EQ(*it, "b");
+    CHECK_EQ(*lines.begin(), "a");
+    CHECK_EQ(++it, lines.end());
+  }
+}
+
+TEST_CASE("splitLinesParallel") {
+  ThreadPool pool(4);
+  InlineExecutor inline_executor;
+  SUBCASE("edge cases") {
+    for (const auto s : edgeCases) {
+      CHECK_EQ(splitLinesParallel(s, pool, 1), splitLines(s));
+      CHECK_EQ(splitLinesParallel(s, inline_executor, 1), splitLines(s));
+    }
+  }
+  SUBCASE("segments of every alignment") {
+    std::string s;
+    for (std::size_t len = 0; s.size() < 2000; len = (len + 7) % 23) {
+      s.append(len, 'x');
+      s.push_back('\n');
+    }
+    for (std::size_t n = 0; n <= s.size(); n += 17) {
+      const auto sub = std::string_view(s).substr(0, n);
+      for (const std::size_t minSegmentSize : {1U, 5U, 64U}) {
+        CHECK_EQ(splitLinesParallel(sub, pool, minSegmentSize),
+                 splitLines(sub));
+      }
+    }
+  }
+  SUBCASE("segments without any new line") {
+    const auto s = std::string(100, 'x') + "\n\n" + std::string(100, 'y');
+    CHECK_EQ(splitLinesParallel(s, pool, 1), splitLines(s));
+  }
+}
+
+TEST_CASE("countLines and splitLinesInto") {
+  SUBCASE("edge cases") {
+    for (const auto s : edgeCases) {
+      const auto expected = splitLines(s);
+      CHECK_EQ(countLines(s), expected.size());
+
+      std::array<std::string_view, 8> buf{};
+      const auto lines = splitLinesInto(s, buf);
+      CHECK_EQ(lines.data(), buf.data());
+      CHECK_UNARY(std::equal(lines.begin(), lines.end(), expected.begin(),
+                             expected.end()));
+
+      std::vector<std::string_view> v;
+      splitLinesInto(s, v);
+      CHECK_EQ(v, expected);
+    }
+  }
+  SUBCASE("vector is reused") {
+    std::vector<std::string_view> v;
+    splitLinesInto("a\nb\nc\nd\n", v);
+    const auto *const data = v.data();
+    splitLinesInto("x\ny", v);
+    CHECK_EQ(v, (std::vector{"x"sv, "y"sv}));
+    CHECK_EQ(v.data(), data);
+  }
+  SUBCASE("too small out throws") {
+    std::array<std::string_view, 2> buf{};
+    CHECK_THROWS_AS(splitLinesInto("a\nb\nc", buf), std::length_error);
+    CHECK_EQ(splitLinesInto("a\nb\n", buf).size(), 2);
+  }
+}
+
+TEST_CASE("trim") {
+  static_assert(trim("  hello world   ") == "hello world");
+  SUBCASE("whitespace on either side") {
+    CHECK_EQ(trim("  hello world   "), "hello world");
+    CHECK_EQ(trim("\t\r\n\v\fx\r\n"), "x");
+    CHECK_EQ(trimFront("  x  "), "x  ");
+    CHECK_EQ(trimBack("  x  "), "  x");
+  }
+  SUBCASE("empty and all whitespace") {
+    CHECK_EQ(trim(""), "");
+    CHECK_EQ(trim(" \t "), "");
+    CHECK_EQ(trimFront(" \t "), "");
+    CHECK_EQ(trimBack(" \t "), "");
+  }
+  SUBCASE("points into the input") {
+    const auto s = "  abc "sv;
+    CHECK_EQ(trim(s).data(), s.data() + 2);
+  }
+  SUBCASE("custom set") { CHECK_EQ(trim("--x-y--", CharSet("-")), "x-y"); }
+  SUBCASE("per line adaptor") {
+    const auto s = "  apple \n\tkiwi\n   \n"sv;
+    // A prvalue vector isn't a viewable_range, the lines need a name
+    const auto lines = splitLines(s);
+    CHECK_EQ(lines | trimmed | ranges::to<std::vector<std::string_view>>(),
+             (std::vector{"apple"sv, "kiwi"sv, ""sv}));
+  }
+}
+
+TEST_CASE("split_sv") {
+  using Pieces = std::vector<std::string_view>;
+  const auto pieces = [](split_sv_view v) { return ranges::to<Pieces>(v); };
+  SUBCASE("single char, like views::split") {
+    CHECK_EQ(pieces("hello  world"sv | split_sv(' ')),
+             (Pieces{"hello", "", "world"}));
+    CHECK_EQ(pieces(split_sv(",a,", ',')), (Pieces{"", "a", ""}));
+    CHECK_EQ(pieces(split_sv(",", ',')), (Pieces{"", ""}));
+    CHECK_EQ(pieces(split_sv("abc", ',')), (Pieces{"abc"}));
+    CHECK_UNARY(split_sv("", ',').empty());
+  }
+  SUBCASE("multi char delimiter") {
+    CHECK_EQ(pieces(split_sv("a::b:c::", "::")), (Pieces{"a", "b:c", ""}));
+    CHECK_EQ(pieces(split_sv(":::", "::")), (Pieces{"", ":"}));
+    CHECK_THROWS_AS(split_sv(""), std::invalid_argument);
+  }
+  SUBCASE("delimiter set") {
+    CHECK_EQ(pieces("a,b;c\td"sv | split_sv(CharSet(",;\t"))),
+             (Pieces{"a", "b", "c", "d"}));
+  }
+  SUBCASE("points into the input") {
+    const auto s = "ab,cd"sv;
+    CHECK_EQ((*++split_sv(s, ',').begin()).data(), s.data() + 3);
+  }
+  SUBCASE("long input across blocks") {
+    std::string s;
+    for (int i = 0; i < 100; ++i) {
+      s += std::to_string(i) + ", ";
+    }
+    const auto got = pieces(split_sv(s, ", "));
+    REQUIRE_EQ(got.size(), 101);
+    CHECK_EQ(got[42], "42");
+    CHECK_EQ(got.back(), "");
+    const auto commaPieces = pieces(split_sv(s, ','));
+    CHECK_EQ(got, commaPieces | trimmed | ranges::to<Pieces>());
+  }
+  SUBCASE("fields of every line") {
+    const auto csv = "a,b\nc\n,d\n"sv;
+    const auto lines = splitLines(csv);
+    const auto fields = lines | ranges::views::transform(split_sv(',')) |
+                        ranges::views::transform([](split_sv_view v) {
+                          return ranges::distance(v);
+                        }) |
+                        ranges::to<std::vector<std::ptrdiff_t>>();
+    CHECK_EQ(fields, (std::vector<std::ptrdiff_t>{2, 1, 2}));
+  }
+}
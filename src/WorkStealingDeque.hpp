@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev deque, with the memory orders of Lê et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models". One owner thread pushes
+// and pops at the bottom, any thread steals from the top, none of them
+// lock. The slots are atomics, so T must be trivially copyable, typically a
+// pointer to the task.
+template <typename T> class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  explicit WorkStealingDeque(std::size_t capacity = 256) {
+    rings_.push_back(
+        std::make_unique<Ring>(std::bit_ceil(std::max<std::size_t>(capacity, 2))));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+  WorkStealingDeque(WorkStealingDeque &&) = delete;
+  WorkStealingDeque &operator=(WorkStealingDeque &&) = delete;
+  ~WorkStealingDeque() = default;
+
+  // Owner only. Grows when full, the old rings are kept until destruction
+  // since a stealer may still read from them.
+  void push(T x) {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    const std::int64_t t = top_.load(std::memory_order_acquire);
+    Ring *r = ring_.load(std::memory_order_relaxed);
+    if (b - t > r->size() - 1) {
+      r = grow(r, t, b);
+    }
+    r->at(b).store(x, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only, the most recently pushed element
+  std::optional<T> pop() {
+    const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring *r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    std::optional<T> x = r->at(b).load(std::memory_order_relaxed);
+    if (t == b) {
+      // The last element, race the stealers for it
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        x.reset();
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  // Any thread, the oldest element. Only empty when the deque was, a lost
+  // race with another thief is retried.
+  std::optional<T> steal() {
+    for (;;) {
+      std::int64_t t = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const std::int64_t b = bottom_.load(std::memory_order_acquire);
+      if (t >= b) {
+        return std::nullopt;
+      }
+      const T x = ring_.load(std::memory_order_acquire)
+                      ->at(t)
+                      .load(std::memory_order_acquire);
+      if (top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        return x;
+      }
+    }
+  }
+
+  // A snapshot, exact only when no other thread is using the deque
+  [[nodiscard]] bool empty() const noexcept {
+    return bottom_.load(std::memory_order_relaxed) <=
+           top_.load(std::memory_order_relaxed);
+  }
+
+private:
+  class Ring {
+  public:
+    explicit Ring(std::size_t n)
+        : mask_(n - 1), slots_(std::make_unique<std::atomic<T>[]>(n)) {}
+
+    [[nodiscard]] std::int64_t size() const noexcept {
+      return static_cast<std::int64_t>(mask_ + 1);
+    }
+    std::atomic<T> &at(std::int64_t i) noexcept {
+      return slots_[static_cast<std::size_t>(i) & mask_];
+    }
+
+  private:
+    std::size_t mask_;
+    std::unique_ptr<std::atomic<T>[]> slots_;
+  };
+
+  Ring *grow(Ring *r, std::int64_t t, std::int64_t b) {
+    auto bigger = std::make_unique<Ring>(static_cast<std::size_t>(r->size()) * 2);
+    for (std::int64_t i = t; i < b; ++i) {
+      bigger->at(i).store(r->at(i).load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    }
+    Ring *next = bigger.get();
+    rings_.push_back(std::move(bigger));
+    ring_.store(next, std::memory_order_release);
+    return next;
+  }
+
+  alignas(64) std::atomic<std::int64_t> top_{0};
+  alignas(64) std::atomic<std::int64_t> bottom_{0};
+  std::atomic<Ring *> ring_{nullptr};
+  // Every ring ever used, owned here so that late stealers never read freed
+  // memory
+  std::vector<std::unique_ptr<Ring>> rings_;
+};